@@ -57,6 +57,7 @@
 #include <pios_constants.h>
 #include <velocitystate.h>
 #include <positionstate.h>
+#include <callbackinfo.h>
 // Private constants
 
 #define CALLBACK_PRIORITY      CALLBACK_PRIORITY_LOW
@@ -101,7 +102,7 @@ int32_t AltitudeHoldInitialize()
 
     // Create object queue
 
-    altitudeHoldCBInfo = DelayedCallbackCreate(&altitudeHoldTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, STACK_SIZE_BYTES);
+    altitudeHoldCBInfo = DelayedCallbackCreate(&altitudeHoldTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_ALTITUDEHOLD, STACK_SIZE_BYTES);
     AltitudeHoldSettingsConnectCallback(&SettingsUpdatedCb);
 
     return 0;
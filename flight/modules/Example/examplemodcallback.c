@@ -71,7 +71,7 @@ int32_t ExampleModCallbackInitialize()
     // Listen for ExampleObject1 updates, connect a callback function
     ExampleObject1ConnectCallback(&ObjectUpdatedCb);
 
-    cbinfo = DelayedCallbackCreate(&DelayedCb, CALLBACK_PRIORITY, CBTASK_PRIORITY, STACK_SIZE);
+    cbinfo = DelayedCallbackCreate(&DelayedCb, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACK_ID_UNMONITORED, STACK_SIZE);
 
     return 0;
 }
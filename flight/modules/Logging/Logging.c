@@ -36,6 +36,12 @@
 #include "debuglogstatus.h"
 #include "debuglogentry.h"
 #include "flightstatus.h"
+#include "callbackinfo.h"
+
+// private constants
+#define STREAM_STACK_SIZE    512
+#define STREAM_CALLBACK_PRIO CALLBACK_PRIORITY_LOW
+#define STREAM_TASK_PRIO     CALLBACK_TASK_AUXILIARY
 
 // private variables
 static DebugLogSettingsData settings;
@@ -43,12 +49,20 @@ static DebugLogControlData control;
 static DebugLogStatusData status;
 static FlightStatusData flightstatus;
 static DebugLogEntryData *entry; // would be better on stack but event dispatcher stack might be insufficient
+static DebugLogEntryData *streamEntry;
+static DelayedCallbackInfo *streamCallback;
+static uint16_t streamFlight;
+static uint16_t streamNext;
+static uint16_t streamRemaining;
+static bool streamWaiting; // an entry is waiting to be sent by telemetry
 
 // private functions
 static void SettingsUpdatedCb(UAVObjEvent *ev);
 static void ControlUpdatedCb(UAVObjEvent *ev);
 static void StatusUpdatedCb(UAVObjEvent *ev);
 static void FlightStatusUpdatedCb(UAVObjEvent *ev);
+static void EntrySentCb(UAVObjEvent *ev);
+static void StreamCb(void);
 
 int32_t LoggingInitialize(void)
 {
@@ -62,6 +76,14 @@ int32_t LoggingInitialize(void)
     if (!entry) {
         return -1;
     }
+    streamEntry = pvPortMalloc(sizeof(DebugLogEntryData));
+    if (!streamEntry) {
+        return -1;
+    }
+    streamCallback = DelayedCallbackCreate(&StreamCb, STREAM_CALLBACK_PRIO, STREAM_TASK_PRIO, CALLBACKINFO_RUNNING_DEBUGLOGSTREAM, STREAM_STACK_SIZE);
+    if (!streamCallback) {
+        return -1;
+    }
 
     return 0;
 }
@@ -71,6 +93,7 @@ int32_t LoggingStart(void)
     DebugLogSettingsConnectCallback(SettingsUpdatedCb);
     DebugLogControlConnectCallback(ControlUpdatedCb);
     FlightStatusConnectCallback(FlightStatusUpdatedCb);
+    UAVObjConnectCallback(DebugLogEntryHandle(), EntrySentCb, EV_UPDATE_SENT);
     SettingsUpdatedCb(DebugLogSettingsHandle());
 
     UAVObjEvent ev = { .obj = DebugLogSettingsHandle(), .instId = 0, .event = EV_UPDATED_PERIODIC };
@@ -85,6 +108,7 @@ MODULE_INITCALL(LoggingInitialize, LoggingStart);
 static void StatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     PIOS_DEBUGLOG_Info(&status.Flight, &status.Entry, &status.FreeSlots, &status.UsedSlots);
+    status.DroppedUpdates = PIOS_DEBUGLOG_Dropped();
     DebugLogStatusSet(&status);
 }
 
@@ -128,6 +152,13 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
             entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
         }
         DebugLogEntrySet(entry);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_RETRIEVERANGE) {
+        // a new range replaces a stream still in progress
+        streamFlight    = control.Flight;
+        streamNext      = control.Entry;
+        streamRemaining = control.Count;
+        streamWaiting   = false;
+        DelayedCallbackDispatch(streamCallback);
     } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_FORMATFLASH) {
         uint8_t armed;
         FlightStatusArmedGet(&armed);
@@ -138,6 +169,45 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     StatusUpdatedCb(ev);
 }
 
+/**
+ * Telemetry is done with the streamed entry, push the next one
+ */
+static void EntrySentCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    if (streamWaiting) {
+        streamWaiting = false;
+        DelayedCallbackDispatch(streamCallback);
+    }
+}
+
+/**
+ * Push the next entry of a RetrieveRange request. Telemetry sends the
+ * object data as it is when the update gets its turn, so the next entry is
+ * only pushed once telemetry reports the update as sent (EntrySentCb). If
+ * that gets lost the GCS asks for the rest of the range again.
+ */
+static void StreamCb(void)
+{
+    if (!streamRemaining) {
+        return;
+    }
+
+    memset(streamEntry, 0, sizeof(DebugLogEntryData));
+    if (PIOS_DEBUGLOG_Read(streamEntry, streamFlight, streamNext) != 0) {
+        // end of this flight's log, let the GCS know and stop
+        streamEntry->Flight = streamFlight;
+        streamEntry->Entry  = streamNext;
+        streamEntry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
+        streamRemaining     = 0;
+    } else {
+        streamNext++;
+        streamRemaining--;
+    }
+    streamWaiting = streamRemaining > 0;
+    DebugLogEntrySet(streamEntry);
+    DebugLogEntryUpdated();
+}
+
 
 /**
  * @}
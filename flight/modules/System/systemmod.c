@@ -53,6 +53,7 @@
 #include <taskinfo.h>
 #include <watchdogstatus.h>
 #include <taskinfo.h>
+#include <callbackinfo.h>
 #include <hwsettings.h>
 #include <pios_flashfs.h>
 #if defined(PIOS_INCLUDE_RFM22B)
@@ -105,6 +106,7 @@ static void objectUpdatedCb(UAVObjEvent *ev);
 static void hwSettingsUpdatedCb(UAVObjEvent *ev);
 #ifdef DIAG_TASKS
 static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context);
+static void callbackSchedulerForEachCallback(int16_t callback_id, const DelayedCallbackStats *callback_info, void *context);
 #endif
 static void updateStats();
 static void updateSystemAlarms();
@@ -147,6 +149,7 @@ int32_t SystemModInitialize(void)
     ObjectPersistenceInitialize();
 #ifdef DIAG_TASKS
     TaskInfoInitialize();
+    CallbackInfoInitialize();
 #endif
 #ifdef DIAG_I2C_WDG_STATS
     I2CStatsInitialize();
@@ -204,6 +207,8 @@ static void systemTask(__attribute__((unused)) void *parameters)
 
 #ifdef DIAG_TASKS
     TaskInfoData taskInfoData;
+    CallbackInfoData callbackInfoData;
+    memset(&callbackInfoData, 0, sizeof(callbackInfoData));
 #endif
 
     // Main system loop
@@ -223,6 +228,9 @@ static void systemTask(__attribute__((unused)) void *parameters)
         // Update the task status object
         PIOS_TASK_MONITOR_ForEachTask(taskMonitorForEachCallback, &taskInfoData);
         TaskInfoSet(&taskInfoData);
+        // Update the callback status object
+        CallbackSchedulerForEachCallback(callbackSchedulerForEachCallback, &callbackInfoData);
+        CallbackInfoSet(&callbackInfoData);
 #endif
 
         // Flash the heartbeat LED
@@ -440,6 +448,21 @@ static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_
     ((uint16_t *)&taskData->StackRemaining)[task_id] = task_info->stack_remaining;
     ((uint8_t *)&taskData->RunningTime)[task_id]     = task_info->running_time_percentage;
 }
+
+static void callbackSchedulerForEachCallback(int16_t callback_id, const DelayedCallbackStats *callback_info, void *context)
+{
+    CallbackInfoData *callbackData = (CallbackInfoData *)context;
+
+    // callback_id's are the indices of the members of the CallbackInfoXXXXElem enums
+    if (callback_id < 0 || callback_id >= CALLBACKINFO_RUNNING_NUMELEM) {
+        return;
+    }
+    cast_struct_to_array(callbackData->Running, callbackData->Running.EventDispatcher)[callback_id] = callback_info->is_running ? CALLBACKINFO_RUNNING_TRUE : CALLBACKINFO_RUNNING_FALSE;
+    ((uint32_t *)&callbackData->RunCount)[callback_id]       = callback_info->run_count;
+    ((uint32_t *)&callbackData->AverageRunTime)[callback_id] = callback_info->average_run_time;
+    ((uint32_t *)&callbackData->MaxRunTime)[callback_id]     = callback_info->max_run_time;
+    ((uint32_t *)&callbackData->MaxQueueDelay)[callback_id]  = callback_info->max_queue_delay;
+}
 #endif
 
 /**
@@ -317,6 +317,10 @@ static void processObjEvent(UAVObjEvent *ev)
             if (success == -1) {
                 ++txErrors;
             }
+            // Let whoever paces manual updates know the data is not needed anymore
+            if (ev->event == EV_UPDATED_MANUAL) {
+                UAVObjInstanceUpdateSent(ev->obj, ev->instId);
+            }
         } else if (ev->event == EV_UPDATE_REQ) {
             // Request object update from GCS (with retries)
             while (retries < MAX_RETRIES && success == -1) {
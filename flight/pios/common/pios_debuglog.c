@@ -32,9 +32,17 @@
 #include "pios.h"
 #include "uavobjectmanager.h"
 #include "debuglogentry.h"
+#if defined(PIOS_INCLUDE_FREERTOS)
+#include "callbackscheduler.h"
+#include "callbackinfo.h"
+#endif
 
 // global definitions
 
+// Packed records: objid (4), instid (2), time offset (2), size (2), payload
+#define PACKED_HEADER_SIZE 10
+#define PACKED_MAX_OFFSET  0xffff
+#define WRITER_STACK_SIZE  512
 
 // Global variables
 extern uintptr_t pios_user_fs_id; // flash filesystem for logging
@@ -52,11 +60,24 @@ static bool logging_enabled = false;
 static uint16_t flightnum   = 0;
 static uint16_t lognum = 0;
 static DebugLogEntryData *buffer = 0;
-#if !defined(PIOS_INCLUDE_FREERTOS)
+static uint32_t dropped = 0;
+#if defined(PIOS_INCLUDE_FREERTOS)
+// Two packing buffers: callers fill one while the writer saves the other
+static DebugLogEntryData *packbuffer[2] = { 0, 0 };
+static uint8_t fillindex = 0;
+static volatile bool write_pending = false;
+static DelayedCallbackInfo *writer = 0;
+#else
 static DebugLogEntryData staticbuffer;
 #endif
 
 /* Private Function Prototypes */
+#if defined(PIOS_INCLUDE_FREERTOS)
+static void writerCb(void);
+static void waitWriter(void);
+static bool handOver(void);
+static void packUAVObject(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
+#endif
 
 /**
  * @brief Initialize the log facility
@@ -67,6 +88,14 @@ void PIOS_DEBUGLOG_Initialize()
     if (!mutex) {
         mutex  = xSemaphoreCreateRecursiveMutex();
         buffer = pvPortMalloc(sizeof(DebugLogEntryData));
+        packbuffer[0] = pvPortMalloc(sizeof(DebugLogEntryData));
+        packbuffer[1] = pvPortMalloc(sizeof(DebugLogEntryData));
+        if (packbuffer[0] && packbuffer[1]) {
+            packbuffer[0]->Size = 0;
+            packbuffer[1]->Size = 0;
+            // without the writer every object is saved in its own entry
+            writer = DelayedCallbackCreate(&writerCb, CALLBACK_PRIORITY_LOW, CALLBACK_TASK_AUXILIARY, CALLBACKINFO_RUNNING_DEBUGLOGWRITER, WRITER_STACK_SIZE);
+        }
     }
 #else
     buffer = &staticbuffer;
@@ -90,6 +119,17 @@ void PIOS_DEBUGLOG_Initialize()
  */
 void PIOS_DEBUGLOG_Enable(uint8_t enabled)
 {
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (!enabled && writer) {
+        // don't keep packed records around until logging resumes
+        mutexlock();
+        if (!handOver()) {
+            waitWriter();
+            handOver();
+        }
+        mutexunlock();
+    }
+#endif
     logging_enabled = enabled;
 }
 
@@ -106,6 +146,17 @@ void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8
     if (!logging_enabled || !buffer) {
         return;
     }
+    if (size > sizeof(buffer->Data)) {
+        // never log a partial object
+        dropped++;
+        return;
+    }
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (writer) {
+        packUAVObject(objid, instid, size, data);
+        return;
+    }
+#endif
     mutexlock();
     buffer->Flight     = flightnum;
 #if defined(PIOS_INCLUDE_FREERTOS)
@@ -117,10 +168,7 @@ void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8
     buffer->Type       = DEBUGLOGENTRY_TYPE_UAVOBJECT;
     buffer->ObjectID   = objid;
     buffer->InstanceID = instid;
-    if (size > sizeof(buffer->Data)) {
-        size = sizeof(buffer->Data);
-    }
-    buffer->Size = size;
+    buffer->Size       = size;
     memset(buffer->Data, 0xff, sizeof(buffer->Data));
     memcpy(buffer->Data, data, size);
 
@@ -143,6 +191,14 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
     va_list args;
     va_start(args, format);
     mutexlock();
+#if defined(PIOS_INCLUDE_FREERTOS)
+    // keep the entries in order with the records packed so far, the text
+    // entry takes the next entry number so the writer has to be done with it
+    waitWriter();
+    if (handOver()) {
+        waitWriter();
+    }
+#endif
     memset(buffer->Data, 0xff, sizeof(buffer->Data));
     vsnprintf((char *)buffer->Data, sizeof(buffer->Data), (char *)format, args);
     buffer->Flight     = flightnum;
@@ -161,6 +217,7 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
         lognum++;
     }
     mutexunlock();
+    va_end(args);
 }
 
 
@@ -213,12 +270,140 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
 void PIOS_DEBUGLOG_Format(void)
 {
     mutexlock();
+#if defined(PIOS_INCLUDE_FREERTOS)
+    // let the writer finish a save in progress before erasing, whatever is
+    // still packed belongs to the erased log
+    waitWriter();
+    if (writer) {
+        packbuffer[0]->Size = 0;
+        packbuffer[1]->Size = 0;
+    }
+#endif
+    dropped = 0;
     PIOS_FLASHFS_Format(pios_user_fs_id);
     lognum    = 0;
     flightnum = 0;
     mutexunlock();
 }
 
+/**
+ * @brief Number of object updates that were not logged because the writer
+ * could not keep up or they do not fit in an entry, since boot or the last format
+ */
+uint32_t PIOS_DEBUGLOG_Dropped(void)
+{
+    return dropped;
+}
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * @brief Append an object update to the packing buffer, handing the buffer
+ * over to the writer once the record does not fit anymore. Never waits for
+ * the flash, if the writer is still busy with the other buffer the update
+ * is dropped.
+ */
+static void packUAVObject(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
+{
+    uint32_t now = xTaskGetTickCount() * portTICK_RATE_MS;
+
+    mutexlock();
+    if (size > sizeof(buffer->Data) - PACKED_HEADER_SIZE) {
+        dropped++;
+        mutexunlock();
+        return;
+    }
+    DebugLogEntryData *pack = packbuffer[fillindex];
+    if (pack->Size > 0 && (pack->Size + PACKED_HEADER_SIZE + size > sizeof(pack->Data) || now - pack->FlightTime > PACKED_MAX_OFFSET)) {
+        if (!handOver()) {
+            dropped++;
+            mutexunlock();
+            return;
+        }
+        pack = packbuffer[fillindex];
+    }
+
+    if (pack->Size == 0) {
+        pack->Flight     = flightnum;
+        pack->FlightTime = now;
+        pack->Type       = DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS;
+        pack->ObjectID   = 0;
+        pack->InstanceID = 0;
+        memset(pack->Data, 0xff, sizeof(pack->Data));
+    }
+
+    uint8_t *record = &pack->Data[pack->Size];
+    uint16_t offset = now - pack->FlightTime;
+    record[0] = objid & 0xff;
+    record[1] = (objid >> 8) & 0xff;
+    record[2] = (objid >> 16) & 0xff;
+    record[3] = (objid >> 24) & 0xff;
+    record[4] = instid & 0xff;
+    record[5] = (instid >> 8) & 0xff;
+    record[6] = offset & 0xff;
+    record[7] = (offset >> 8) & 0xff;
+    record[8] = size & 0xff;
+    record[9] = (size >> 8) & 0xff;
+    memcpy(&record[PACKED_HEADER_SIZE], data, size);
+    pack->Size += PACKED_HEADER_SIZE + size;
+    pack->InstanceID++; // number of records in this entry
+    mutexunlock();
+}
+
+/**
+ * @brief Wait until the writer has saved the buffer handed over to it
+ * @note Must be called while holding the mutex, which is released meanwhile
+ */
+static void waitWriter(void)
+{
+    while (write_pending) {
+        mutexunlock();
+        vTaskDelay(1);
+        mutexlock();
+    }
+}
+
+/**
+ * @brief Pass the packing buffer on to the writer and continue in the other one.
+ * The entry number is only taken by the writer once the save succeeded.
+ * @note Must be called while holding the mutex
+ * @return false if the writer is still busy with the other buffer
+ */
+static bool handOver(void)
+{
+    if (!writer || packbuffer[fillindex]->Size == 0) {
+        return true;
+    }
+    if (write_pending) {
+        return false;
+    }
+    packbuffer[fillindex]->Entry = lognum;
+    write_pending = true;
+    fillindex    ^= 1;
+    packbuffer[fillindex]->Size = 0;
+    DelayedCallbackDispatch(writer);
+    return true;
+}
+
+/**
+ * @brief Save the buffer handed over by the callers, runs in the callback
+ * scheduler so that flash latency never reaches the modules that log
+ */
+static void writerCb(void)
+{
+    if (!write_pending) {
+        return;
+    }
+    // fillindex only changes once write_pending is cleared
+    DebugLogEntryData *pack = packbuffer[fillindex ^ 1];
+    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, pack->Flight * 256, pack->Entry, (uint8_t *)pack, sizeof(DebugLogEntryData)) == 0) {
+        mutexlock();
+        lognum++;
+        mutexunlock();
+    }
+    write_pending = false;
+}
+#endif /* PIOS_INCLUDE_FREERTOS */
+
 /**
  * @}
  * @}
@@ -59,6 +59,12 @@ struct logfs_state {
     /* Underlying flash driver glue */
     const struct pios_flash_driver *driver;
     uintptr_t flash_id;
+
+    /* Optional RAM index of the active arena, holds a 16 bit key of
+     * (obj_id, obj_inst_id) for every active slot so that lookups only
+     * read the slot headers that match instead of every header in the log
+     */
+    uint16_t *slot_keys;
 };
 
 /*
@@ -416,6 +422,39 @@ static bool logfs_log_is_full(const struct logfs_state *logfs)
     return logfs->num_free_slots == 0;
 }
 
+/*
+ * RAM slot index
+ */
+
+#define LOGFS_NO_KEY 0xFFFF
+
+static uint16_t logfs_slot_key(uint32_t obj_id, uint16_t obj_inst_id)
+{
+    uint32_t hash = obj_id ^ (obj_inst_id * 0x9E3779B1);
+
+    hash ^= hash >> 16;
+    if ((uint16_t)hash == LOGFS_NO_KEY) {
+        /* Keep LOGFS_NO_KEY free to mark slots that are not active */
+        return LOGFS_NO_KEY - 1;
+    }
+    return hash;
+}
+
+static void logfs_index_set(struct logfs_state *logfs, uint16_t slot_id, const struct slot_header *slot_hdr)
+{
+    if (logfs->slot_keys) {
+        logfs->slot_keys[slot_id] = (slot_hdr->state == SLOT_STATE_ACTIVE) ?
+                                    logfs_slot_key(slot_hdr->obj_id, slot_hdr->obj_inst_id) : LOGFS_NO_KEY;
+    }
+}
+
+static void logfs_index_clear(struct logfs_state *logfs, uint16_t slot_id)
+{
+    if (logfs->slot_keys) {
+        logfs->slot_keys[slot_id] = LOGFS_NO_KEY;
+    }
+}
+
 static int32_t logfs_unmount_log(struct logfs_state *logfs)
 {
     PIOS_Assert(logfs->mounted);
@@ -455,6 +494,8 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
         PIOS_Assert(slot_hdr.state == SLOT_STATE_EMPTY ||
                     logfs->num_free_slots == 0);
 
+        logfs_index_set(logfs, slot_id, &slot_hdr);
+
         switch (slot_hdr.state) {
         case SLOT_STATE_EMPTY:
             logfs->num_free_slots++;
@@ -490,13 +531,24 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
         return NULL;
     }
 
-    logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->magic     = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->slot_keys = NULL;
     return logfs;
 }
+static void PIOS_FLASHFS_Logfs_alloc_index(__attribute__((unused)) struct logfs_state *logfs)
+{
+#if defined(PIOS_FLASHFS_LOGFS_INDEX)
+    /* Without the index lookups fall back to scanning the log */
+    logfs->slot_keys = (uint16_t *)pvPortMalloc((logfs->cfg->arena_size / logfs->cfg->slot_size) * sizeof(uint16_t));
+#endif
+}
 static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 {
     /* Invalidate the magic */
     logfs->magic = ~PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    if (logfs->slot_keys) {
+        vPortFree(logfs->slot_keys);
+    }
     vPortFree(logfs);
 }
 #else
@@ -511,10 +563,15 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
     }
 
     logfs = &pios_flashfs_logfs_devs[pios_flashfs_logfs_num_devs++];
-    logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->magic     = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->slot_keys = NULL;
 
     return logfs;
 }
+static void PIOS_FLASHFS_Logfs_alloc_index(__attribute__((unused)) struct logfs_state *logfs)
+{
+    /* No heap, lookups scan the log */
+}
 static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 {
     /* Invalidate the magic */
@@ -560,6 +617,8 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
     logfs->flash_id = flash_id; /* lower-level flash device id */
     logfs->mounted  = false;
 
+    PIOS_FLASHFS_Logfs_alloc_index(logfs);
+
     if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
         rc = -1;
         goto out_exit;
@@ -714,6 +773,35 @@ static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct sl
         *curr_slot = 1;
     }
 
+    if (logfs->slot_keys) {
+        /* Only read the headers of active slots with a matching key, the free slots are all at the end */
+        uint16_t key = logfs_slot_key(obj_id, obj_inst_id);
+        uint16_t end = (logfs->cfg->arena_size / logfs->cfg->slot_size) - logfs->num_free_slots;
+        for (uint16_t slot_id = *curr_slot; slot_id < end; slot_id++) {
+            if (logfs->slot_keys[slot_id] != key) {
+                continue;
+            }
+
+            uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
+            if (logfs->driver->read_data(logfs->flash_id,
+                                         slot_addr,
+                                         (uint8_t *)slot_hdr,
+                                         sizeof(*slot_hdr)) != 0) {
+                return -2;
+            }
+            if (slot_hdr->state == SLOT_STATE_ACTIVE &&
+                slot_hdr->obj_id == obj_id &&
+                slot_hdr->obj_inst_id == obj_inst_id) {
+                /* Found what we were looking for */
+                *curr_slot = slot_id;
+                return 0;
+            }
+        }
+
+        /* No matching entry was found */
+        return -1;
+    }
+
     for (uint16_t slot_id = *curr_slot;
          slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
          slot_id++) {
@@ -770,6 +858,7 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
                 goto out_exit;
             }
             /* Object has been successfully obsoleted and is no longer active */
+            logfs_index_clear(logfs, curr_slot_id);
             logfs->num_active_slots--;
             break;
         case -1:
@@ -890,6 +979,7 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
     }
 
     /* Object has been successfully written to the slot */
+    logfs_index_set(logfs, free_slot_id, &slot_hdr);
     logfs->num_active_slots++;
     return 0;
 }
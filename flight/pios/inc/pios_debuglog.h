@@ -89,6 +89,12 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
  */
 void PIOS_DEBUGLOG_Format(void);
 
+/**
+ * @brief Number of object updates that were not logged because the writer
+ * could not keep up or they do not fit in an entry, since boot or the last format
+ */
+uint32_t PIOS_DEBUGLOG_Dropped(void);
+
 #endif // ifndef PIOS_DEBUGLOG_H
 
 /**
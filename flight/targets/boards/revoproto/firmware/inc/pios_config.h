@@ -111,6 +111,7 @@
 #define PIOS_INCLUDE_FLASH_INTERNAL
 #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
 #define FLASH_FREERTOS
+#define PIOS_FLASHFS_LOGFS_INDEX /* RAM index of the slots, 2 bytes per slot */
 /* #define PIOS_INCLUDE_FLASH_EEPROM */
 
 /* PIOS radio modules */
@@ -92,6 +92,7 @@
 
 #define PIOS_INCLUDE_SETTINGS
 #define PIOS_INCLUDE_FLASH
+#define PIOS_FLASHFS_LOGFS_INDEX
 /* A really shitty setting saving implementation */
 // #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
 
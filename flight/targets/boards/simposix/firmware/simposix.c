@@ -34,6 +34,10 @@
 #include "inc/openpilot.h"
 #include <systemmod.h>
 #include <uavobjectsinit.h>
+#ifdef UAVO_BENCHMARK
+#include <stdio.h>
+#include <time.h>
+#endif
 
 /* Task Priorities */
 #define PRIORITY_TASK_HOOKS (tskIDLE_PRIORITY + 3)
@@ -72,6 +76,9 @@ static xTaskHandle initTaskHandle;
 
 /* Function Prototypes */
 static void initTask(void *parameters);
+#ifdef UAVO_BENCHMARK
+static void uavoBenchmark(void);
+#endif
 
 /* Prototype of generated InitModules() function */
 extern void InitModules(void);
@@ -129,10 +136,91 @@ void initTask(__attribute__((unused)) void *parameters)
     /* Initialize modules */
     MODULE_INITIALISE_ALL;
 
+#ifdef UAVO_BENCHMARK
+    uavoBenchmark();
+#endif
+
     /* terminate this task */
     vTaskDelete(NULL);
 }
 
+#ifdef UAVO_BENCHMARK
+/**
+ * Benchmark of UAVObjGetByID(), built with "make fw_simposix UAVO_BENCHMARK=YES".
+ *
+ * Looks up every registered object and metaobject, as the telemetry RX path
+ * does for each received packet, and compares with a walk of the object list
+ * like the one UAVObjGetByID() used to do (minus its locking).
+ */
+#define BENCHMARK_MAX_OBJECTS 512
+#define BENCHMARK_ROUNDS      1000
+
+static UAVObjHandle benchmarkHandles[BENCHMARK_MAX_OBJECTS];
+static uint32_t benchmarkCount;
+
+static void benchmarkCollect(UAVObjHandle obj)
+{
+    if (benchmarkCount < BENCHMARK_MAX_OBJECTS) {
+        benchmarkHandles[benchmarkCount++] = obj;
+    }
+}
+
+static UAVObjHandle benchmarkLinearLookup(uint32_t id)
+{
+    for (uint32_t i = 0; i < benchmarkCount; i++) {
+        if (UAVObjGetID(benchmarkHandles[i]) == id) {
+            return benchmarkHandles[i];
+        }
+    }
+    return NULL;
+}
+
+static double benchmarkElapsedNs(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e9 + (now.tv_nsec - start->tv_nsec);
+}
+
+static void uavoBenchmark(void)
+{
+    struct timespec start;
+    uint32_t lookups = 0;
+    uint32_t misses  = 0;
+
+    benchmarkCount = 0;
+    UAVObjIterate(&benchmarkCollect);
+    if (benchmarkCount == 0) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t round = 0; round < BENCHMARK_ROUNDS; round++) {
+        for (uint32_t i = 0; i < benchmarkCount; i++) {
+            if (UAVObjGetByID(UAVObjGetID(benchmarkHandles[i])) != benchmarkHandles[i]) {
+                misses++;
+            }
+            lookups++;
+        }
+    }
+    double indexedNs = benchmarkElapsedNs(&start) / lookups;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t round = 0; round < BENCHMARK_ROUNDS; round++) {
+        for (uint32_t i = 0; i < benchmarkCount; i++) {
+            if (benchmarkLinearLookup(UAVObjGetID(benchmarkHandles[i])) != benchmarkHandles[i]) {
+                misses++;
+            }
+        }
+    }
+    double linearNs = benchmarkElapsedNs(&start) / lookups;
+
+    fprintf(stderr, "UAVObjGetByID: %u objects, indexed %.1f ns/lookup, list walk %.1f ns/lookup, %u mismatches\n",
+            (unsigned int)benchmarkCount, indexedNs, linearNs, (unsigned int)misses);
+}
+#endif /* UAVO_BENCHMARK */
+
 /**
  * @}
  * @}
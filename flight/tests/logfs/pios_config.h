@@ -4,6 +4,7 @@
 /* Enable/Disable PiOS modules */
 #define PIOS_INCLUDE_FLASH
 // #define PIOS_FLASHFS_LOGFS_MAX_DEVS 5
+#define PIOS_FLASHFS_LOGFS_INDEX
 #define PIOS_INCLUDE_FREERTOS
 
 #endif /* PIOS_CONFIG_H */
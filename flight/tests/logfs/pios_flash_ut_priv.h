@@ -8,6 +8,9 @@ struct pios_flash_ut_cfg {
 int32_t PIOS_Flash_UT_Init(uintptr_t *flash_id, const struct pios_flash_ut_cfg *cfg);
 
 int32_t PIOS_Flash_UT_Destroy(uintptr_t flash_id);
+
+/* Number of read_data calls since init, to measure filesystem flash traffic */
+uint32_t PIOS_Flash_UT_GetReadCount(uintptr_t flash_id);
 extern const struct pios_flash_driver pios_ut_flash_driver;
 
 #if !defined(FLASH_IMAGE_FILE)
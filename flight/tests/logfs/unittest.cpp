@@ -1,8 +1,8 @@
 #include "gtest/gtest.h"
 
-#include <stdio.h> /* printf */
 #include <stdlib.h> /* abort */
 #include <string.h> /* memset */
+#include <time.h> /* clock_gettime */
 
 extern "C" {
 #include "pios_flash.h" /* PIOS_FLASH_* API */
@@ -297,6 +297,33 @@ TEST_F(LogfsTestCooked, WriteManyVerify) {
     EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
 }
 
+TEST_F(LogfsTestCooked, WriteDeleteRemountVerify) {
+    uint16_t num_slots = flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size;
+
+    /* Write more versions than fit in the arena so that gc runs in between */
+    for (uint16_t i = 0; i < num_slots + num_slots / 2; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 100, (i % 2) ? obj1 : obj1_alt, sizeof(obj1)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, 42));
+
+    /* Mount again so the lookups below run on state rebuilt from flash */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint16_t i = 0; i < 100; i++) {
+        memset(obj1_check, 0, sizeof(obj1_check));
+        if (i == 42) {
+            EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+            continue;
+        }
+        /* Loop index of the last save of instance i decides which version it holds */
+        uint16_t last = ((num_slots + num_slots / 2 - 1 - i) / 100) * 100 + i;
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp((last % 2) ? obj1 : obj1_alt, obj1_check, sizeof(obj1_check)));
+    }
+}
+
 class LogfsTestCookedMultiPart : public LogfsTestRaw {
 protected:
     virtual void SetUp()
@@ -392,3 +419,70 @@ TEST_F(LogfsTestCookedMultiPart, WriteLarge) {
     memset(obj4_check, 0, sizeof(obj4_check));
     EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ4_ID, 0, obj4_check, sizeof(obj4_check)));
 }
+
+/*
+ * Benchmarks: fill partition a the way the firmware does and measure boot
+ * (mounting and loading every object, like the settings) and in order
+ * lookups (like a debug log download). The timings are recorded as test
+ * properties, see --gtest_output=xml.
+ */
+class LogfsBenchmark : public LogfsTestCooked {
+protected:
+    static double now_ms()
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+    }
+
+    void fill(uint16_t num_objs)
+    {
+        for (uint16_t i = 0; i < num_objs; i++) {
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, 256, i, obj1, sizeof(obj1)));
+        }
+    }
+
+    static const uint16_t NUM_OBJS = 250;
+};
+
+TEST_F(LogfsBenchmark, BootTime) {
+    fill(NUM_OBJS);
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+
+    uint32_t reads = PIOS_Flash_UT_GetReadCount(flash_id);
+    double start   = now_ms();
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint16_t i = 0; i < NUM_OBJS; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, 256, i, obj1_check, sizeof(obj1_check)));
+    }
+    reads = PIOS_Flash_UT_GetReadCount(flash_id) - reads;
+
+    RecordProperty("MountAndLoadMicroseconds", (int)((now_ms() - start) * 1000));
+    RecordProperty("MountAndLoadFlashReads", (int)reads);
+
+    /* One scan of the arena to mount, then about a header and a data read per object */
+    uint16_t num_slots = flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size;
+    EXPECT_GT((uint32_t)(num_slots + 4 * NUM_OBJS), reads);
+}
+
+TEST_F(LogfsBenchmark, LookupTime) {
+    fill(NUM_OBJS);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    uint32_t reads = PIOS_Flash_UT_GetReadCount(flash_id);
+    double start   = now_ms();
+    for (uint16_t i = 0; i < NUM_OBJS; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, 256, i, obj1_check, sizeof(obj1_check)));
+    }
+    /* Entries that were never written must not cost a scan of flash either */
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, 256, NUM_OBJS, obj1_check, sizeof(obj1_check)));
+    reads = PIOS_Flash_UT_GetReadCount(flash_id) - reads;
+
+    RecordProperty("LoadMicroseconds", (int)((now_ms() - start) * 1000));
+    RecordProperty("LoadFlashReads", (int)reads);
+
+    EXPECT_GT((uint32_t)(4 * NUM_OBJS), reads);
+}
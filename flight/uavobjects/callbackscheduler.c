@@ -33,12 +33,23 @@
 #define MAX_SLEEP  1000
 
 // Private types
+/**
+ * ready queue of one callback priority
+ */
+struct DelayedCallbackQueueStruct {
+    DelayedCallbackInfo *head;
+    DelayedCallbackInfo *tail;
+    uint16_t count; // callbacks waiting in this queue
+    uint16_t roundLeft; // callbacks to run before a lower priority gets its slot
+};
+
 /**
  * task information
  */
 struct DelayedCallbackTaskStruct {
-    DelayedCallbackInfo *callbackQueue[CALLBACK_PRIORITY_LOW + 1];
-    DelayedCallbackInfo *queueCursor[CALLBACK_PRIORITY_LOW + 1];
+    struct DelayedCallbackQueueStruct readyQueue[CALLBACK_PRIORITY_LOW + 1];
+    DelayedCallbackInfo *callbacks;
+    uint32_t    nextSchedule; // earliest pending schedule, 0 if there is none
     xTaskHandle callbackSchedulerTaskHandle;
     signed char name[3];
     uint32_t    stackSize;
@@ -53,9 +64,18 @@ struct DelayedCallbackTaskStruct {
 struct DelayedCallbackInfoStruct {
     DelayedCallback   cb;
     bool volatile     waiting;
+    bool volatile     running; // the callback is executing right now
     uint32_t volatile scheduletime;
     struct DelayedCallbackTaskStruct *task;
     struct DelayedCallbackInfoStruct *next;
+    struct DelayedCallbackInfoStruct *readyNext;
+    DelayedCallbackPriority priority;
+    int16_t  callbackID;
+    uint32_t readyTime; // PIOS_DELAY raw time the callback became ready
+    uint32_t runCount;
+    uint32_t maxRunTime;
+    uint32_t maxQueueDelay;
+    uint64_t totalRunTime;
 };
 
 
@@ -66,7 +86,10 @@ static bool schedulerStarted;
 
 // Private functions
 static void CallbackSchedulerTask(void *task);
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static void makeReady(DelayedCallbackInfo *info);
+static DelayedCallbackInfo *takeReady(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static int32_t checkSchedules(struct DelayedCallbackTaskStruct *task);
+static void runCallback(DelayedCallbackInfo *info);
 
 /**
  * Initialize the scheduler
@@ -175,6 +198,9 @@ int32_t DelayedCallbackSchedule(
             result = 2;
         }
         cbinfo->scheduletime = new;
+        if (!cbinfo->task->nextSchedule || (int32_t)(new - cbinfo->task->nextSchedule) < 0) {
+            cbinfo->task->nextSchedule = new;
+        }
 
         // scheduler needs to be notified to adapt sleep times
         xSemaphoreGive(cbinfo->task->signal);
@@ -195,8 +221,10 @@ int32_t DelayedCallbackDispatch(DelayedCallbackInfo *cbinfo)
 {
     PIOS_Assert(cbinfo);
 
-    // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    // the ready queues are shared with interrupts, no semaphore can be used
+    portENTER_CRITICAL();
+    makeReady(cbinfo);
+    portEXIT_CRITICAL();
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGive(cbinfo->task->signal);
 }
@@ -219,8 +247,9 @@ int32_t DelayedCallbackDispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigh
 {
     PIOS_Assert(cbinfo);
 
-    // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    unsigned portBASE_TYPE mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    makeReady(cbinfo);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGiveFromISR(cbinfo->task->signal, pxHigherPriorityTaskWoken);
 }
@@ -234,6 +263,7 @@ int32_t DelayedCallbackDispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigh
  * \param[in] priorityTask Task priority of the scheduler task. One scheduler task will be spawned for each distinct value specified,
  *            further callbacks created  with the same priorityTask will all be handled by the same delayed callback scheduler task
  *            and scheduled according to their individual callback priorities
+ * \param[in] callbackID Index of the callback in the CallbackInfo object, CALLBACK_ID_UNMONITORED if it should not be reported
  * \param[in] stacksize The stack requirements of the callback when called by the scheduler.
  * \return CallbackInfo Pointer on success, NULL if failed.
  */
@@ -241,6 +271,7 @@ DelayedCallbackInfo *DelayedCallbackCreate(
     DelayedCallback cb,
     DelayedCallbackPriority priority,
     DelayedCallbackPriorityTask priorityTask,
+    int16_t callbackID,
     uint32_t stacksize)
 {
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
@@ -265,9 +296,13 @@ DelayedCallbackInfo *DelayedCallbackCreate(
 
         // initialize structure
         for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
-            task->callbackQueue[p] = NULL;
-            task->queueCursor[p]   = NULL;
+            task->readyQueue[p].head      = NULL;
+            task->readyQueue[p].tail      = NULL;
+            task->readyQueue[p].count     = 0;
+            task->readyQueue[p].roundLeft = 0;
         }
+        task->callbacks    = NULL;
+        task->nextSchedule = 0;
         task->name[0]      = 'C';
         task->name[1]      = 'a' + t;
         task->name[2]      = 0;
@@ -318,14 +353,23 @@ DelayedCallbackInfo *DelayedCallbackCreate(
         xSemaphoreGiveRecursive(mutex);
         return NULL; // error - not enough memory
     }
-    info->next    = NULL;
-    info->waiting = false;
-    info->scheduletime = 0;
-    info->task    = task;
-    info->cb = cb;
-
-    // add to scheduling queue
-    LL_APPEND(task->callbackQueue[priority], info);
+    info->next      = NULL;
+    info->readyNext = NULL;
+    info->waiting   = false;
+    info->running   = false;
+    info->scheduletime  = 0;
+    info->task          = task;
+    info->cb            = cb;
+    info->priority      = priority;
+    info->callbackID    = callbackID;
+    info->readyTime     = 0;
+    info->runCount      = 0;
+    info->maxRunTime    = 0;
+    info->maxQueueDelay = 0;
+    info->totalRunTime  = 0;
+
+    // add to the callbacks of this task
+    LL_APPEND(task->callbacks, info);
 
     xSemaphoreGiveRecursive(mutex);
 
@@ -333,81 +377,202 @@ DelayedCallbackInfo *DelayedCallbackCreate(
 }
 
 /**
- * Scheduler subtask
- * \param[in] task The scheduler task in question
- * \param[in] priority The scheduling priority of the callback to search for
- * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ * Iterate over all registered callbacks that have a callback ID
+ * \param[in] callback Called with the statistics of each monitored callback
+ * \param[in] context Passed to the callback unchanged
  */
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
+void CallbackSchedulerForEachCallback(DelayedCallbackStatsCallback callback, void *context)
 {
-    int32_t result = MAX_SLEEP;
-    int32_t diff   = 0;
+    if (!mutex) {
+        return;
+    }
 
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    struct DelayedCallbackTaskStruct *task = NULL;
+    LL_FOREACH(schedulerTasks, task) {
+        DelayedCallbackInfo *info = NULL;
+        LL_FOREACH(task->callbacks, info) {
+            if (info->callbackID < 0) {
+                continue;
+            }
+            DelayedCallbackStats stats;
+            // the statistics are updated by the scheduler task without locking
+            portENTER_CRITICAL();
+            stats.is_running       = info->running || info->waiting || info->scheduletime != 0;
+            stats.run_count        = info->runCount;
+            stats.average_run_time = info->runCount ? (uint32_t)(info->totalRunTime / info->runCount) : 0;
+            stats.max_run_time     = info->maxRunTime;
+            stats.max_queue_delay  = info->maxQueueDelay;
+            portEXIT_CRITICAL();
+            callback(info->callbackID, &stats, context);
+        }
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * Append a callback to the ready queue of its priority, unless it is waiting already
+ * Must be called with interrupts masked
+ * \param[in] info The callback to run
+ */
+static void makeReady(DelayedCallbackInfo *info)
+{
+    if (info->waiting) {
+        return;
+    }
+    struct DelayedCallbackQueueStruct *queue = &info->task->readyQueue[info->priority];
+    info->waiting   = true;
+    info->readyTime = PIOS_DELAY_GetRaw();
+    info->readyNext = NULL;
+    if (queue->tail) {
+        queue->tail->readyNext = info;
+    } else {
+        queue->head = info;
+    }
+    queue->tail = info;
+    queue->count++;
+}
+
+/**
+ * Take the next callback to run off the ready queues
+ * Every time all callbacks that were waiting in a queue at the start of a
+ * round have been run, one callback of the next lower priority gets a slot.
+ * Must be called with interrupts masked
+ * \param[in] task The scheduler task in question
+ * \param[in] priority The scheduling priority to start searching at
+ * \return the callback to run, NULL if none is waiting
+ */
+static DelayedCallbackInfo *takeReady(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
+{
     // no such queue
     if (priority > CALLBACK_PRIORITY_LOW) {
-        return result;
+        return NULL;
     }
 
-    // queue is empty, search a lower priority queue
-    if (task->callbackQueue[priority] == NULL) {
-        return runNextCallback(task, priority + 1);
+    struct DelayedCallbackQueueStruct *queue = &task->readyQueue[priority];
+    if (!queue->roundLeft || !queue->head) {
+        // start a new round, a lower priority callback goes first
+        queue->roundLeft = queue->count;
+        DelayedCallbackInfo *lower = takeReady(task, priority + 1);
+        if (lower || !queue->head) {
+            return lower;
+        }
     }
 
-    DelayedCallbackInfo *current = task->queueCursor[priority];
-    DelayedCallbackInfo *next;
-    do {
-        if (current == NULL) {
-            next = task->callbackQueue[priority]; // loop around the end of the list
-            // also attempt to run a callback that has lower priority
-            // every time the queue is completely traversed
-            diff = runNextCallback(task, priority + 1);
-            if (!diff) {
-                task->queueCursor[priority] = next; // the recursive call has executed a callback
-                return 0;
-            }
-            if (diff < result) {
-                result = diff; // adjust sleep time
-            }
+    DelayedCallbackInfo *info = queue->head;
+    queue->head = info->readyNext;
+    if (!queue->head) {
+        queue->tail = NULL;
+    }
+    queue->count--;
+    if (queue->roundLeft) {
+        queue->roundLeft--;
+    }
+    info->readyNext = NULL;
+    info->waiting   = false; // the flag is reset just before execution.
+    return info;
+}
+
+/**
+ * Move all callbacks whose schedule is due to the ready queues
+ * \param[in] task The scheduler task in question
+ * \return wait time until the next scheduled callback is due
+ */
+static int32_t checkSchedules(struct DelayedCallbackTaskStruct *task)
+{
+    int32_t result = MAX_SLEEP;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
+
+    if (task->nextSchedule) {
+        uint32_t now = xTaskGetTickCount();
+        int32_t diff = task->nextSchedule - now;
+        if (diff > 0) {
+            result = diff; // nothing due yet
         } else {
-            next = current->next;
-            xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
-            if (current->scheduletime) {
-                diff = current->scheduletime - xTaskGetTickCount();
+            task->nextSchedule = 0;
+            DelayedCallbackInfo *info = NULL;
+            LL_FOREACH(task->callbacks, info) {
+                if (!info->scheduletime) {
+                    continue;
+                }
+                diff = info->scheduletime - now;
                 if (diff <= 0) {
-                    current->waiting = true;
-                } else if (diff < result) {
-                    result = diff; // adjust sleep time
+                    portENTER_CRITICAL();
+                    makeReady(info);
+                    portEXIT_CRITICAL();
+                } else {
+                    if (diff < result) {
+                        result = diff; // adjust sleep time
+                    }
+                    if (!task->nextSchedule || (int32_t)(info->scheduletime - task->nextSchedule) < 0) {
+                        task->nextSchedule = info->scheduletime;
+                    }
                 }
             }
-            if (current->waiting) {
-                task->queueCursor[priority] = next;
-                current->scheduletime = 0; // any schedules are reset
-                current->waiting = false; // the flag is reset just before execution.
-                xSemaphoreGiveRecursive(mutex);
-                current->cb(); // call the callback
-                return 0;
-            }
-            xSemaphoreGiveRecursive(mutex);
         }
-        current = next;
-    } while (current != task->queueCursor[priority]);
-    // once the list has been traversed entirely without finding any to be executed task, abort (nothing to do)
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+
     return result;
 }
 
+/**
+ * Invoke a callback that has been taken off the ready queues and account its run time
+ * \param[in] info The callback to run
+ */
+static void runCallback(DelayedCallbackInfo *info)
+{
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    info->scheduletime = 0; // any schedules are reset
+    xSemaphoreGiveRecursive(mutex);
+
+    uint32_t queueDelay = PIOS_DELAY_DiffuS(info->readyTime);
+    uint32_t start = PIOS_DELAY_GetRaw();
+
+    info->running = true;
+    info->cb(); // call the callback
+    info->running = false;
+
+    uint32_t runTime = PIOS_DELAY_DiffuS(start);
+
+    portENTER_CRITICAL();
+    info->runCount++;
+    info->totalRunTime += runTime;
+    if (runTime > info->maxRunTime) {
+        info->maxRunTime = runTime;
+    }
+    if (queueDelay > info->maxQueueDelay) {
+        info->maxQueueDelay = queueDelay;
+    }
+    portEXIT_CRITICAL();
+}
+
 /**
  * Scheduler task, responsible of invoking callbacks.
  * \param[in] task The scheduling task being run
  */
 static void CallbackSchedulerTask(void *task)
 {
-    uint32_t delay = 0;
+    struct DelayedCallbackTaskStruct *self = (struct DelayedCallbackTaskStruct *)task;
+    DelayedCallbackInfo *info;
+    int32_t delay;
 
     while (1) {
-        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
-        if (delay) {
+        delay = checkSchedules(self);
+
+        portENTER_CRITICAL();
+        info  = takeReady(self, CALLBACK_PRIORITY_CRITICAL);
+        portEXIT_CRITICAL();
+
+        if (info) {
+            runCallback(info);
+        } else {
             // nothing to do but sleep
-            xSemaphoreTake(((struct DelayedCallbackTaskStruct *)task)->signal, delay);
+            xSemaphoreTake(self->signal, delay);
         }
     }
 }
@@ -27,6 +27,7 @@
 #include <openpilot.h>
 
 #include <taskinfo.h>
+#include <callbackinfo.h>
 
 // Private constants
 #if defined(PIOS_EVENTDISAPTCHER_QUEUE)
@@ -45,6 +46,15 @@
 #define TASK_PRIORITY        CALLBACK_TASK_FLIGHTCONTROL
 #define MAX_UPDATE_PERIOD_MS 1000
 
+// The heap of periodic events is stored in chunks allocated on demand, so
+// that growing it never copies or frees the entries themselves. Only the
+// table of chunk pointers is reallocated, doubling its size when full. With
+// heap_1 (F1 targets) vPortFree() does not reclaim the old tables, but as they
+// double this wastes less than one extra table: 4 bytes per 32 events.
+#define HEAP_CHUNK_SIZE      32
+#define HEAP_INITIAL_CHUNKS  4
+#define HEAP_NOT_QUEUED      0xFFFF
+
 // Private types
 
 
@@ -63,6 +73,7 @@ typedef struct {
 struct PeriodicObjectListStruct {
     EventCallbackInfo evInfo; /** Event callback information */
     uint16_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
+    uint16_t heapIndex; /** Position in the heap of periodic events, or HEAP_NOT_QUEUED */
     int32_t  timeToNextUpdateMs; /** Time delay to the next update */
     struct PeriodicObjectListStruct *next; /** Needed by linked list library (utlist.h) */
 };
@@ -70,6 +81,9 @@ typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList *mObjList;
+static PeriodicObjectList * * *mHeapChunks; /** Min-heap of the periodic events, by timeToNextUpdateMs */
+static uint16_t mHeapNumChunks;
+static uint16_t mHeapSize;
 static xQueueHandle mQueue;
 static DelayedCallbackInfo *eventSchedulerCallback;
 static xSemaphoreHandle mMutex;
@@ -81,6 +95,9 @@ static void eventTask();
 static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static uint16_t randomizePeriod(uint16_t periodMs);
+static int32_t heapInsert(PeriodicObjectList *objEntry);
+static void heapRemove(PeriodicObjectList *objEntry);
+static void heapUpdate(PeriodicObjectList *objEntry);
 
 
 /**
@@ -90,7 +107,10 @@ static uint16_t randomizePeriod(uint16_t periodMs);
 int32_t EventDispatcherInitialize()
 {
     // Initialize variables
-    mObjList = NULL;
+    mObjList  = NULL;
+    mHeapChunks    = NULL;
+    mHeapNumChunks = 0;
+    mHeapSize = 0;
     memset(&mStats, 0, sizeof(EventStats));
 
     // Create mMutex
@@ -103,7 +123,7 @@ int32_t EventDispatcherInitialize()
     mQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
 
     // Create callback
-    eventSchedulerCallback = DelayedCallbackCreate(&eventTask, CALLBACK_PRIORITY, TASK_PRIORITY, STACK_SIZE * 4);
+    eventSchedulerCallback = DelayedCallbackCreate(&eventTask, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_EVENTDISPATCHER, STACK_SIZE * 4);
     DelayedCallbackDispatch(eventSchedulerCallback);
 
     // Done
@@ -229,6 +249,7 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     // Create handle
     objEntry = (PeriodicObjectList *)pvPortMalloc(sizeof(PeriodicObjectList));
     if (objEntry == NULL) {
+        xSemaphoreGiveRecursive(mMutex);
         return -1;
     }
     objEntry->evInfo.ev.obj      = ev->obj;
@@ -238,6 +259,13 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     objEntry->evInfo.queue       = queue;
     objEntry->updatePeriodMs     = periodMs;
     objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+    objEntry->heapIndex = HEAP_NOT_QUEUED;
+    // Schedule it, if periodic
+    if (periodMs > 0 && heapInsert(objEntry) != 0) {
+        vPortFree(objEntry);
+        xSemaphoreGiveRecursive(mMutex);
+        return -1;
+    }
     // Add to list
     LL_APPEND(mObjList, objEntry);
     // Release lock
@@ -269,9 +297,18 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
             // Object found, update period
             objEntry->updatePeriodMs     = periodMs;
             objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+            // Reschedule it
+            int32_t result = 0;
+            if (periodMs == 0) {
+                heapRemove(objEntry);
+            } else if (objEntry->heapIndex != HEAP_NOT_QUEUED) {
+                heapUpdate(objEntry);
+            } else {
+                result = heapInsert(objEntry);
+            }
             // Release lock
             xSemaphoreGiveRecursive(mMutex);
-            return 0;
+            return result;
         }
     }
     // If this point is reached the object was not found
@@ -323,44 +360,169 @@ static int32_t processPeriodicUpdates()
     // Get lock
     xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = xTaskGetTickCount() * portTICK_RATE_MS + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(mObjList, objEntry) {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0) {
-            // Check if time for the next update
-            timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
-            if (objEntry->timeToNextUpdateMs <= timeNow) {
-                // Reset timer
-                offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
-                objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-                // Invoke callback, if one
-                if (objEntry->evInfo.cb != 0) {
-                    objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-                }
-                // Push event to queue, if one
-                if (objEntry->evInfo.queue != 0) {
-                    if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE) { // do not block if queue is full
-                        if (objEntry->evInfo.ev.obj != NULL) {
-                            mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
-                        }
-                        ++mStats.eventErrors;
-                    }
+    // Pop the objects that are due from the heap, their update time is
+    // pushed back by one period before the event is sent out.
+    timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+    while (mHeapSize > 0) {
+        objEntry = mHeapChunks[0][0];
+        if (objEntry->timeToNextUpdateMs > timeNow) {
+            break;
+        }
+        // Reset timer
+        offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
+        objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
+        heapUpdate(objEntry);
+        // Invoke callback, if one
+        if (objEntry->evInfo.cb != 0) {
+            objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+        }
+        // Push event to queue, if one
+        if (objEntry->evInfo.queue != 0) {
+            if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE) { // do not block if queue is full
+                if (objEntry->evInfo.ev.obj != NULL) {
+                    mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
                 }
-            }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate) {
-                timeToNextUpdate = objEntry->timeToNextUpdateMs;
+                ++mStats.eventErrors;
             }
         }
     }
 
+    // The next update is the one at the top of the heap
+    timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+    if (mHeapSize > 0 && mHeapChunks[0][0]->timeToNextUpdateMs < timeToNextUpdate) {
+        timeToNextUpdate = mHeapChunks[0][0]->timeToNextUpdateMs;
+    }
+
     // Done
     xSemaphoreGiveRecursive(mMutex);
     return timeToNextUpdate;
 }
 
+/**
+ * Heap accessors, the heap is a binary min-heap of the periodic events
+ * ordered by timeToNextUpdateMs. The mutex must be held.
+ */
+static inline PeriodicObjectList *heapGet(uint16_t index)
+{
+    return mHeapChunks[index / HEAP_CHUNK_SIZE][index % HEAP_CHUNK_SIZE];
+}
+
+static inline void heapSet(uint16_t index, PeriodicObjectList *objEntry)
+{
+    mHeapChunks[index / HEAP_CHUNK_SIZE][index % HEAP_CHUNK_SIZE] = objEntry;
+    objEntry->heapIndex = index;
+}
+
+static void heapSiftUp(uint16_t index)
+{
+    PeriodicObjectList *objEntry = heapGet(index);
+
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        PeriodicObjectList *parentEntry = heapGet(parent);
+        if (parentEntry->timeToNextUpdateMs <= objEntry->timeToNextUpdateMs) {
+            break;
+        }
+        heapSet(index, parentEntry);
+        index = parent;
+    }
+    heapSet(index, objEntry);
+}
+
+static void heapSiftDown(uint16_t index)
+{
+    PeriodicObjectList *objEntry = heapGet(index);
+
+    for (;;) {
+        uint32_t child = 2 * (uint32_t)index + 1;
+        if (child >= mHeapSize) {
+            break;
+        }
+        if (child + 1 < mHeapSize &&
+            heapGet(child + 1)->timeToNextUpdateMs < heapGet(child)->timeToNextUpdateMs) {
+            child++;
+        }
+        PeriodicObjectList *childEntry = heapGet(child);
+        if (objEntry->timeToNextUpdateMs <= childEntry->timeToNextUpdateMs) {
+            break;
+        }
+        heapSet(index, childEntry);
+        index = child;
+    }
+    heapSet(index, objEntry);
+}
+
+/**
+ * Add an event to the heap
+ * \return Success (0), failure (-1)
+ */
+static int32_t heapInsert(PeriodicObjectList *objEntry)
+{
+    uint16_t chunk = mHeapSize / HEAP_CHUNK_SIZE;
+
+    // The last index is reserved for HEAP_NOT_QUEUED
+    if (mHeapSize >= HEAP_NOT_QUEUED - 1) {
+        return -1;
+    }
+    if (chunk >= mHeapNumChunks) {
+        uint16_t numChunks = mHeapNumChunks ? mHeapNumChunks * 2 : HEAP_INITIAL_CHUNKS;
+        PeriodicObjectList * * *chunks = (PeriodicObjectList * * *)pvPortMalloc(numChunks * sizeof(PeriodicObjectList * *));
+        if (chunks == NULL) {
+            return -1;
+        }
+        memset(chunks, 0, numChunks * sizeof(PeriodicObjectList * *));
+        if (mHeapChunks) {
+            memcpy(chunks, mHeapChunks, mHeapNumChunks * sizeof(PeriodicObjectList * *));
+            vPortFree(mHeapChunks);
+        }
+        mHeapChunks    = chunks;
+        mHeapNumChunks = numChunks;
+    }
+    if (mHeapChunks[chunk] == NULL) {
+        mHeapChunks[chunk] = (PeriodicObjectList * *)pvPortMalloc(HEAP_CHUNK_SIZE * sizeof(PeriodicObjectList *));
+        if (mHeapChunks[chunk] == NULL) {
+            return -1;
+        }
+    }
+    heapSet(mHeapSize, objEntry);
+    ++mHeapSize;
+    heapSiftUp(objEntry->heapIndex);
+    return 0;
+}
+
+/**
+ * Remove an event from the heap, if it is in it
+ */
+static void heapRemove(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    if (index == HEAP_NOT_QUEUED) {
+        return;
+    }
+    objEntry->heapIndex = HEAP_NOT_QUEUED;
+    --mHeapSize;
+    if (index < mHeapSize) {
+        // Move the last event in the hole and restore the heap order
+        heapSet(index, heapGet(mHeapSize));
+        heapUpdate(heapGet(index));
+    }
+}
+
+/**
+ * Restore the heap order after the update time of an event changed
+ */
+static void heapUpdate(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    if (index > 0 && heapGet((index - 1) / 2)->timeToNextUpdateMs > objEntry->timeToNextUpdateMs) {
+        heapSiftUp(index);
+    } else {
+        heapSiftDown(index);
+    }
+}
+
 /**
  * Return a psedorandom integer from 0 to periodMs
  * Based on the Park-Miller-Carta Pseudo-Random Number Generator
@@ -105,6 +105,27 @@ typedef struct DelayedCallbackInfoStruct DelayedCallbackInfo;
 // Be aware that using different priorityTasks for the same callback function
 // might cause your callback to be executed recursively in different task contexts!
 
+#define CALLBACK_ID_UNMONITORED -1
+// Use the callback ID to report the run time statistics of a callback in the
+// CallbackInfo object. Each ID is the index of the callback in the
+// CALLBACKINFO_RUNNING_* enum, callbacks that should not be reported use
+// CALLBACK_ID_UNMONITORED.
+
+typedef struct {
+    /** Flag indicating whether the callback is executing, dispatched or scheduled. */
+    bool     is_running;
+    /** Number of times the callback has been invoked since boot. */
+    uint32_t run_count;
+    /** Average and longest execution time of the callback in microseconds. */
+    uint32_t average_run_time;
+    uint32_t max_run_time;
+    /** Longest time in microseconds between dispatch and invocation. */
+    uint32_t max_queue_delay;
+} DelayedCallbackStats;
+
+typedef void (*DelayedCallbackStatsCallback)(int16_t callback_id, const DelayedCallbackStats *stats, void *context);
+// Iterator callback, called for each monitored callback by CallbackSchedulerForEachCallback()
+
 // Public functions
 //
 
@@ -134,6 +155,7 @@ int32_t CallbackSchedulerStart();
  * \param[in] cb The callback to be invoked
  * \param[in] priority Priority of the callback compared to other callbacks scheduled by the same delayed callback scheduler task.
  * \param[in] priorityTask Task priority of the scheduler task. One scheduler task will be spawned for each distinct value specified, further callbacks created  with the same priorityTask will all be handled by the same delayed callback scheduler task and scheduled according to their individual callback priorities
+ * \param[in] callbackID Index of the callback in the CallbackInfo object, CALLBACK_ID_UNMONITORED if it should not be reported
  * \param[in] stacksize The stack requirements of the callback when called by the scheduler.
  * \return CallbackInfo Pointer on success, NULL if failed.
  */
@@ -141,6 +163,7 @@ DelayedCallbackInfo *DelayedCallbackCreate(
     DelayedCallback cb,
     DelayedCallbackPriority priority,
     DelayedCallbackPriorityTask priorityTask,
+    int16_t callbackID,
     uint32_t stacksize);
 
 /**
@@ -184,4 +207,11 @@ int32_t DelayedCallbackDispatch(DelayedCallbackInfo *cbinfo);
  */
 int32_t DelayedCallbackDispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigherPriorityTaskWoken);
 
+/**
+ * Iterate over all registered callbacks that have a callback ID
+ * \param[in] callback Called with the statistics of each monitored callback
+ * \param[in] context Passed to the callback unchanged
+ */
+void CallbackSchedulerForEachCallback(DelayedCallbackStatsCallback callback, void *context);
+
 #endif // CALLBACKSCHEDULER_H
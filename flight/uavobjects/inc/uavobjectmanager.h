@@ -96,7 +96,8 @@ typedef enum {
     EV_UPDATED_PERIODIC = 0x08, /** Object update from periodic event */
     EV_LOGGING_MANUAL   = 0x10, /** Object update event manually generated */
     EV_LOGGING_PERIODIC = 0x20, /** Object update from periodic event */
-    EV_UPDATE_REQ = 0x40 /** Request to update object data */
+    EV_UPDATE_REQ = 0x40, /** Request to update object data */
+    EV_UPDATE_SENT      = 0x80 /** Telemetry is done with a manual object update (sent or given up) */
 } UAVObjEventType;
 
 /**
@@ -208,6 +209,7 @@ void UAVObjRequestUpdate(UAVObjHandle obj);
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId);
 void UAVObjUpdated(UAVObjHandle obj);
 void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId);
+void UAVObjInstanceUpdateSent(UAVObjHandle obj_handle, uint16_t instId);
 void UAVObjLogging(UAVObjHandle obj);
 void UAVObjInstanceLogging(UAVObjHandle obj_handle, uint16_t instId);
 void UAVObjIterate(void (*iterator)(UAVObjHandle obj));
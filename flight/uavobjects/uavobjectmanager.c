@@ -180,6 +180,8 @@ static InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId);
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask);
 static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
+static void indexInsert(struct UAVOData *obj);
+static struct UAVOData *indexFind(uint32_t id);
 
 // Private variables
 static xSemaphoreHandle mutex;
@@ -197,6 +199,24 @@ static const UAVObjMetadata defMetadata = {
 
 static UAVObjStats stats;
 
+/*
+ * Registered objects sorted by ID, for lookups by ID without walking the
+ * whole handle table. It has one entry per handle slot and is only written
+ * with the mutex held. Readers do not take the mutex:
+ * - entries are volatile, so the shift in indexInsert() stores them one
+ *   pointer at a time and in order, and every entry below the count is
+ *   always a valid object (possibly one that moved up by one slot)
+ * - the count is only raised after a barrier, once the new entry and the
+ *   shifted ones are stored
+ * A lookup that runs concurrently with an insert can therefore miss an
+ * object that is being shifted, but never reads an unwritten entry; it then
+ * retries under the mutex. Inserts must never run concurrently with each
+ * other, which the mutex ensures.
+ */
+static struct UAVOData *volatile *uavo_index;
+static volatile uint16_t uavo_index_count;
+static uint16_t uavo_index_size;
+
 /**
  * Initialize the object manager
  * \return 0 Success
@@ -218,6 +238,14 @@ int32_t UAVObjInitialize()
     memset(__start__uavo_handles, 0,
            (uintptr_t)__stop__uavo_handles - (uintptr_t)__start__uavo_handles);
 
+    // Allocate the ID index, one entry for each handle slot
+    uavo_index_count = 0;
+    uavo_index_size  = __start__uavo_handles ? (__stop__uavo_handles - __start__uavo_handles) : 0;
+    uavo_index = uavo_index_size ? (struct UAVOData *volatile *)pvPortMalloc(uavo_index_size * sizeof(*uavo_index)) : NULL;
+    if (uavo_index == NULL) {
+        uavo_index_size = 0;
+    }
+
     // Create mutex
     mutex = xSemaphoreCreateRecursiveMutex();
     if (mutex == NULL) {
@@ -373,6 +401,9 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     /* Initialize the embedded meta UAVO */
     UAVObjInitMetaData(&uavo_data->metaObj);
 
+    /* Make the object visible to UAVObjGetByID() */
+    indexInsert(uavo_data);
+
     /* Initialize object fields and metadata to default values */
     if (initCb) {
         initCb((UAVObjHandle)uavo_data, 0);
@@ -395,6 +426,62 @@ unlock_exit:
     return (UAVObjHandle)uavo_data;
 }
 
+/**
+ * Insert an object into the ID index, the mutex must be held.
+ * Lock-free lookups may run concurrently, see uavo_index.
+ * \param[in] obj The object to insert
+ */
+static void indexInsert(struct UAVOData *obj)
+{
+    uint16_t pos = uavo_index_count;
+
+    if (uavo_index_count >= uavo_index_size) {
+        /* No room left, UAVObjGetByID() falls back to walking the handle table */
+        return;
+    }
+
+    /* The object must be complete before a reader can reach it */
+    WRITE_MEMORY_BARRIER();
+
+    /* Shift the larger IDs up, writing each pointer in one go */
+    while (pos > 0 && uavo_index[pos - 1]->id > obj->id) {
+        uavo_index[pos] = uavo_index[pos - 1];
+        pos--;
+    }
+    uavo_index[pos] = obj;
+
+    /* Publish the new count only once all the entries below it are stored */
+    WRITE_MEMORY_BARRIER();
+    uavo_index_count++;
+}
+
+/**
+ * Binary search of the ID index
+ * \param[in] id The object ID, of a data object
+ * \return The object or NULL if not found.
+ */
+static struct UAVOData *indexFind(uint32_t id)
+{
+    uint16_t low  = 0;
+    uint16_t high = uavo_index_count;
+
+    /* Pairs with the barrier before the count is raised in indexInsert() */
+    READ_MEMORY_BARRIER();
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        struct UAVOData *obj = uavo_index[mid];
+
+        if (obj->id == id) {
+            return obj;
+        } else if (obj->id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return NULL;
+}
+
 /**
  * Retrieve an object from the list given its id
  * \param[in] The object ID
@@ -403,11 +490,33 @@ unlock_exit:
 UAVObjHandle UAVObjGetByID(uint32_t id)
 {
     UAVObjHandle *found_obj = (UAVObjHandle *)NULL;
+    struct UAVOData *index_obj;
 
-    // Get lock
+    // Lock-free lookup, of a data object first and then of a metaobject
+    index_obj = indexFind(id);
+    if (index_obj) {
+        return (UAVObjHandle)index_obj;
+    }
+    index_obj = indexFind(id - 1);
+    if (index_obj && MetaObjectId(index_obj->id) == id) {
+        return (UAVObjHandle) & (index_obj->metaObj);
+    }
+
+    // Not found, look again with the lock held in case an object was being registered
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
-    // Look for object
+    index_obj = indexFind(id);
+    if (index_obj) {
+        found_obj = (UAVObjHandle *)index_obj;
+        goto unlock_exit;
+    }
+    index_obj = indexFind(id - 1);
+    if (index_obj && MetaObjectId(index_obj->id) == id) {
+        found_obj = (UAVObjHandle *)&(index_obj->metaObj);
+        goto unlock_exit;
+    }
+
+    // Objects that did not fit in the index
     UAVO_LIST_ITERATE(tmp_obj)
     if (tmp_obj->id == id) {
         found_obj = (UAVObjHandle *)tmp_obj;
@@ -1652,6 +1761,20 @@ void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
     xSemaphoreGiveRecursive(mutex);
 }
 
+/**
+ * Trigger a EV_UPDATE_SENT event for an object instance, telemetry calls
+ * this once it is done with a EV_UPDATED_MANUAL event.
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ */
+void UAVObjInstanceUpdateSent(UAVObjHandle obj_handle, uint16_t instId)
+{
+    PIOS_Assert(obj_handle);
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATE_SENT);
+    xSemaphoreGiveRecursive(mutex);
+}
+
 /**
  * Trigger a EV_UPDATED event for an object instance.
  * \param[in] obj The object handle
@@ -16,7 +16,9 @@ SOURCES += opmaps.cpp \
     point.cpp \
     size.cpp \
     kibertilecache.cpp \
-    diagnostics.cpp
+    diagnostics.cpp \
+    tilefetcher.cpp \
+    decodedtilecache.cpp
 HEADERS += opmaps.h \
     size.h \
     maptype.h \
@@ -37,4 +39,6 @@ HEADERS += opmaps.h \
     point.h \
     kibertilecache.h \
     debugheader.h \
-    diagnostics.h
+    diagnostics.h \
+    tilefetcher.h \
+    decodedtilecache.h
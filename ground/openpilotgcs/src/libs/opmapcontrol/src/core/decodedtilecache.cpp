@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ *
+ * @file       decodedtilecache.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "decodedtilecache.h"
+#include <climits>
+
+
+namespace core {
+DecodedTileCache::DecodedTileCache() : hits(0), misses(0)
+{
+    cache.setMaxCost(64 * 1048576);
+}
+
+void DecodedTileCache::setCapacity(const int &value)
+{
+    QMutexLocker lock(&mutex);
+
+    // QCache counts the cost in an int, larger budgets are capped
+    cache.setMaxCost((int)qBound((qint64)0, (qint64)value * 1048576, (qint64)INT_MAX));
+}
+int DecodedTileCache::Capacity()
+{
+    QMutexLocker lock(&mutex);
+
+    return cache.maxCost() / 1048576;
+}
+double DecodedTileCache::Size()
+{
+    QMutexLocker lock(&mutex);
+
+    return cache.totalCost() / 1048576.0;
+}
+
+bool DecodedTileCache::Find(const RawTile &tile, QImage &image)
+{
+    QMutexLocker lock(&mutex);
+    // looking an image up marks it as recently used
+    QImage *cached = cache.object(tile);
+
+    if (!cached) {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    image = *cached;
+    return true;
+}
+void DecodedTileCache::Insert(const RawTile &tile, const QImage &image)
+{
+    QMutexLocker lock(&mutex);
+
+    cache.insert(tile, new QImage(image), image.byteCount());
+}
+void DecodedTileCache::Clear()
+{
+    QMutexLocker lock(&mutex);
+
+    cache.clear();
+}
+
+int DecodedTileCache::Hits()
+{
+    QMutexLocker lock(&mutex);
+
+    return hits;
+}
+int DecodedTileCache::Misses()
+{
+    QMutexLocker lock(&mutex);
+
+    return misses;
+}
+
+QImage DecodedTileCache::Decode(const QByteArray &data)
+{
+    QImage image = QImage::fromData(data);
+
+    if (image.isNull() || image.format() == QImage::Format_ARGB32_Premultiplied) {
+        return image;
+    }
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+}
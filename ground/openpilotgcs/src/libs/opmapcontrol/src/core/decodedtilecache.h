@@ -1,9 +1,9 @@
 /**
  ******************************************************************************
  *
- * @file       traillineitem.h
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a WayPoint
+ * @file       decodedtilecache.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief
  * @see        The GNU Public License (GPL) Version 3
  * @defgroup   OPMapWidget
  * @{
@@ -24,32 +24,42 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
-#ifndef TAILLINEITEM_H
-#define TAILLINEITEM_H
+#ifndef DECODEDTILECACHE_H
+#define DECODEDTILECACHE_H
 
-#include <QGraphicsItem>
-#include <QPainter>
-#include <QLabel>
-#include "../internals/pointlatlng.h"
-#include <QObject>
-#include "mapgraphicitem.h"
+#include "rawtile.h"
+#include <QMutex>
+#include <QCache>
+#include <QImage>
 
-namespace mapcontrol {
-class TrailLineItem : public QObject, public QGraphicsLineItem {
-    Q_OBJECT Q_INTERFACES(QGraphicsItem)
+namespace core {
+/**
+ * Decoded tiles ready to be drawn, so that a tile is not decoded again every
+ * time it comes back into view. The least recently used images are dropped
+ * once their size exceeds the capacity.
+ */
+class DecodedTileCache {
 public:
-    enum { Type = UserType + 7 };
-    TrailLineItem(internals::PointLatLng const & coord1, internals::PointLatLng const & coord2, QBrush color, MapGraphicItem *map);
-    int type() const;
-    internals::PointLatLng coord1;
-    internals::PointLatLng coord2;
+    DecodedTileCache();
+
+    void setCapacity(const int &value);
+    int Capacity();
+    double Size();
+    bool Find(const RawTile &tile, QImage &image);
+    void Insert(const RawTile &tile, const QImage &image);
+    void Clear();
+    int Hits();
+    int Misses();
+
+    /// <summary>
+    /// decodes a PNG/JPEG tile to the premultiplied format the painter draws fastest
+    /// </summary>
+    static QImage Decode(const QByteArray &data);
 private:
-    QBrush m_brush;
-    MapGraphicItem *m_map;
-public slots:
-    void setLineSlot();
-signals:
+    QMutex mutex;
+    QCache<RawTile, QImage> cache; // cost in bytes
+    int hits;
+    int misses;
 };
 }
-
-#endif // TAILLINEITEM_H
+#endif // DECODEDTILECACHE_H
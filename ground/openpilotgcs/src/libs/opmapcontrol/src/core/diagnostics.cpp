@@ -26,5 +26,5 @@
  */
 #include "diagnostics.h"
 
-diagnostics::diagnostics() : networkerrors(0), emptytiles(0), timeouts(0), runningThreads(0), tilesFromMem(0), tilesFromNet(0), tilesFromDB(0)
+diagnostics::diagnostics() : networkerrors(0), emptytiles(0), timeouts(0), runningThreads(0), tilesFromMem(0), tilesFromNet(0), tilesFromDB(0), requestsInFlight(0), sharedRequests(0), cancelledRequests(0), imageCacheHits(0), imageCacheMisses(0)
 {}
@@ -36,9 +36,14 @@ struct diagnostics {
     int     tilesFromMem;
     int     tilesFromNet;
     int     tilesFromDB;
+    int     requestsInFlight;
+    int     sharedRequests;
+    int     cancelledRequests;
+    int     imageCacheHits;
+    int     imageCacheMisses;
     QString toString()
     {
-        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB);
+        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7\nRequestsInFlight:%8\nSharedRequests:%9\nCancelledRequests:%10\nImageCacheHits:%11\nImageCacheMisses:%12").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB).arg(requestsInFlight).arg(sharedRequests).arg(cancelledRequests).arg(imageCacheHits).arg(imageCacheMisses);
 
         ;
     }
@@ -25,44 +25,50 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "kibertilecache.h"
+#include <climits>
 
-// TODO add readwrite lock
 
 namespace core {
 KiberTileCache::KiberTileCache()
 {
-    memoryCacheSize = 0;
-    _MemoryCacheCapacity = 22;
+    cache.setMaxCost(22 * 1048576);
 }
 
 void KiberTileCache::setMemoryCacheCapacity(const int &value)
 {
-    kiberCacheLock.lockForWrite();
-    _MemoryCacheCapacity = value;
-    kiberCacheLock.unlock();
+    QMutexLocker lock(&mutex);
+
+    // QCache counts the cost in an int, larger budgets are capped
+    cache.setMaxCost((int)qBound((qint64)0, (qint64)value * 1048576, (qint64)INT_MAX));
 }
 int KiberTileCache::MemoryCacheCapacity()
 {
-    kiberCacheLock.lockForRead();
-    return _MemoryCacheCapacity;
+    QMutexLocker lock(&mutex);
 
-    kiberCacheLock.unlock();
+    return cache.maxCost() / 1048576;
 }
+double KiberTileCache::MemoryCacheSize()
+{
+    QMutexLocker lock(&mutex);
 
-void KiberTileCache::RemoveMemoryOverload()
+    return cache.totalCost() / 1048576.0;
+}
+
+QByteArray KiberTileCache::GetTile(const RawTile &tile)
 {
-    while (MemoryCacheSize() > MemoryCacheCapacity()) {
-        if (cachequeue.count() > 0 && list.count() > 0) {
-#ifdef DEBUG_MEMORY_CACHE
-            qDebug() << "Cleaning Memory cache=" << " started with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
-#endif
-            RawTile first = list.dequeue();
-            memoryCacheSize -= cachequeue.value(first).size();
-            cachequeue.remove(first);
-        }
-    }
+    QMutexLocker lock(&mutex);
+    // looking a tile up marks it as recently used
+    QByteArray *pic = cache.object(tile);
+
+    return pic ? *pic : QByteArray();
+}
+void KiberTileCache::AddTile(const RawTile &tile, const QByteArray &pic)
+{
+    QMutexLocker lock(&mutex);
+
+    cache.insert(tile, new QByteArray(pic), pic.size());
 #ifdef DEBUG_MEMORY_CACHE
-    qDebug() << "Cleaning Memory cache=" << " ended with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
+    qDebug() << "Current memory=" << cache.totalCost() << " in " << cache.count() << " tiles";
 #endif
 }
 }
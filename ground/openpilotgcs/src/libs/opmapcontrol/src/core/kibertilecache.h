@@ -29,28 +29,26 @@
 
 #include "rawtile.h"
 #include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
+#include <QCache>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+/**
+ * Encoded tiles kept in memory, the least recently used tiles are dropped
+ * once the size of all tiles exceeds the capacity.
+ */
 class KiberTileCache {
 public:
     KiberTileCache();
 
     void setMemoryCacheCapacity(const int &value);
     int MemoryCacheCapacity();
-    double MemoryCacheSize()
-    {
-        return memoryCacheSize / 1048576.0;
-    }
-    void RemoveMemoryOverload();
-    QReadWriteLock kiberCacheLock;
-    QHash <RawTile, QByteArray> cachequeue;
-    QQueue <RawTile> list;
-    long memoryCacheSize;
+    double MemoryCacheSize();
+    QByteArray GetTile(const RawTile &tile);
+    void AddTile(const RawTile &tile, const QByteArray &pic);
 private:
-    int _MemoryCacheCapacity;
+    QMutex mutex;
+    QCache<RawTile, QByteArray> cache; // cost in bytes
 };
 }
 #endif // KIBERTILECACHE_H
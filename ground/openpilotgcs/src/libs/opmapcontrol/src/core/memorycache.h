@@ -28,9 +28,6 @@
 #define MEMORYCACHE_H
 
 #include "rawtile.h"
-#include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
 #include "kibertilecache.h"
 #include <QDebug>
 #include "debugheader.h"
@@ -42,7 +39,6 @@ public:
     KiberTileCache TilesInMemory;
     QByteArray GetTileFromMemoryCache(const RawTile &tile);
     void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
-    QReadWriteLock kiberCacheLock;
 };
 }
 #endif // MEMORYCACHE_H
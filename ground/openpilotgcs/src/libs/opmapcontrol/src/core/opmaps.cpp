@@ -52,7 +52,7 @@ OPMaps::~OPMaps()
 }
 
 
-QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom, bool cancellable)
 {
 #ifdef DEBUG_TIMINGS
     QTime time;
@@ -100,16 +100,7 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
             }
         }
         if (accessmode != AccessMode::CacheOnly) {
-            QEventLoop q;
-            QNetworkReply *reply;
             QNetworkRequest qheader;
-            QNetworkAccessManager network;
-            QTimer tT;
-            tT.setSingleShot(true);
-            connect(&network, SIGNAL(finished(QNetworkReply *)),
-                    &q, SLOT(quit()));
-            connect(&tT, SIGNAL(timeout()), &q, SLOT(quit()));
-            network.setProxy(Proxy);
 #ifdef DEBUG_GMAPS
             qDebug() << "Try Tile from the Internet";
 #endif // DEBUG_GMAPS
@@ -193,26 +184,26 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
             default:
                 break;
             }
-            reply = network.get(qheader);
-            tT.start(Timeout);
-            q.exec();
+            TileFetcher::Result result;
+            fetcher.SetProxy(Proxy);
+            ret = fetcher.Fetch(RawTile(type, pos, zoom), qheader, Timeout, &result, cancellable);
 
-            if (!tT.isActive()) {
+            if (result == TileFetcher::Cancelled) {
+                // the tile is not needed anymore
+                return ret;
+            }
+            if (result == TileFetcher::Timeout) {
                 errorvars.lock();
                 ++diag.timeouts;
                 errorvars.unlock();
                 return ret;
             }
-            tT.stop();
-            if ((reply->error() != QNetworkReply::NoError)) {
+            if (result == TileFetcher::NetworkError) {
                 errorvars.lock();
                 ++diag.networkerrors;
                 errorvars.unlock();
-                reply->deleteLater();
                 return ret;
             }
-            ret = reply->readAll();
-            reply->deleteLater(); // TODO can't this be global??
             if (ret.isEmpty()) {
 #ifdef DEBUG_GMAPS
                 qDebug() << "Invalid Tile";
@@ -249,6 +240,24 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
     return ret;
 }
 
+QImage OPMaps::GetDecodedImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    QImage image;
+    RawTile tile(type, pos, zoom);
+
+    if (useMemoryCache && DecodedTiles.Find(tile, image)) {
+        return image;
+    }
+    QByteArray data = GetImageFrom(type, pos, zoom);
+    if (!data.isEmpty()) {
+        image = DecodedTileCache::Decode(data);
+        if (useMemoryCache && !image.isNull()) {
+            DecodedTiles.Insert(tile, image);
+        }
+    }
+    return image;
+}
+
 bool OPMaps::ExportToGMDB(const QString &file)
 {
     return Cache::Instance()->ImageCache.ExportMapDataToDB(Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb", file);
@@ -257,6 +266,24 @@ bool OPMaps::ImportFromGMDB(const QString &file)
 {
     return Cache::Instance()->ImageCache.ExportMapDataToDB(file, Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb");
 }
+bool OPMaps::ExportToMBTiles(const QString &file, const MapType::Types &type)
+{
+    return Cache::Instance()->ImageCache.ExportToMBTiles(file, type);
+}
+bool OPMaps::ImportFromMBTiles(const QString &file, const MapType::Types &type)
+{
+    return Cache::Instance()->ImageCache.ImportFromMBTiles(file, type);
+}
+
+void OPMaps::CancelTilesNotIn(int zoom, const QList<Point> &keep)
+{
+    fetcher.CancelTilesNotIn(zoom, keep);
+}
+
+void OPMaps::CancelAllTiles()
+{
+    fetcher.CancelAll();
+}
 
 diagnostics OPMaps::GetDiagnostics()
 {
@@ -265,6 +292,11 @@ diagnostics OPMaps::GetDiagnostics()
     errorvars.lock();
     i = diag;
     errorvars.unlock();
+    i.requestsInFlight  = fetcher.RequestsInFlight();
+    i.sharedRequests    = fetcher.SharedRequests();
+    i.cancelledRequests = fetcher.CancelledRequests();
+    i.imageCacheHits    = DecodedTiles.Hits();
+    i.imageCacheMisses  = DecodedTiles.Misses();
     return i;
 }
 }
@@ -40,6 +40,8 @@
 #include "alllayersoftype.h"
 #include "urlfactory.h"
 #include "diagnostics.h"
+#include "tilefetcher.h"
+#include "decodedtilecache.h"
 
 // #include "point.h"
 
@@ -51,12 +53,22 @@ public: ~OPMaps();
     static OPMaps *Instance();
     bool ImportFromGMDB(const QString &file);
     bool ExportToGMDB(const QString &file);
+    bool ImportFromMBTiles(const QString &file, const MapType::Types &type);
+    bool ExportToMBTiles(const QString &file, const MapType::Types &type);
     /// <summary>
     /// timeout for map connections
     /// </summary>
 
 
-    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom);
+    /// <summary>
+    /// cancellable downloads are stopped by CancelTilesNotIn and CancelAllTiles
+    /// </summary>
+    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom, bool cancellable = true);
+    /// <summary>
+    /// same as GetImageFrom, decoded and kept in the decoded tile cache
+    /// </summary>
+    QImage GetDecodedImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom);
+    DecodedTileCache DecodedTiles;
     bool UseMemoryCache()
     {
         return useMemoryCache;
@@ -83,6 +95,12 @@ public: ~OPMaps();
     }
     int RetryLoadTile;
     diagnostics GetDiagnostics();
+    /// <summary>
+    /// stops downloading tiles that scrolled out of view, downloads that were not
+    /// requested as cancellable (the map ripper's) go on
+    /// </summary>
+    void CancelTilesNotIn(int zoom, const QList<core::Point> &keep);
+    void CancelAllTiles();
 
 private:
     bool useMemoryCache;
@@ -90,6 +108,7 @@ private:
     AccessMode::Types accessmode;
     // PureImageCache ImageCacheLocal;//TODO Criar acesso Get Set
     TileCacheQueue TileDBcacheQueue;
+    TileFetcher fetcher;
     OPMaps();
     OPMaps(OPMaps const &) {}
     OPMaps & operator=(OPMaps const &)
@@ -29,15 +29,140 @@
 #include <QSettings>
 // #define DEBUG_PUREIMAGECACHE
 namespace core {
+QMutex PureImageCache::Mcounter;
 qlonglong PureImageCache::ConnCounter = 0;
 
-PureImageCache::PureImageCache()
+/**
+ * A database connection of one thread, with its statements prepared once.
+ * Rows in Tiles are found through IndexOfTiles, the Tile blob through the id.
+ */
+class PureImageCache::Connection {
+public:
+    Connection(const QString &file, int Generation) : generation(Generation), name(ConnectionName())
+    {
+        db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(file);
+        open = db.open();
+        if (open) {
+            // WAL keeps readers and the writer apart, with it a commit doesn't need to sync the database file
+            QSqlQuery(db).exec("PRAGMA synchronous=NORMAL");
+        }
+        select     = new QSqlQuery(db);
+        find       = new QSqlQuery(db);
+        insertTile = new QSqlQuery(db);
+        insertData = new QSqlQuery(db);
+        if (open) {
+            open = select->prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?)")
+                   && find->prepare("SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?")
+                   && insertTile->prepare("INSERT INTO Tiles(X, Y, Zoom, Type, Date) VALUES(?, ?, ?, ?, ?)")
+                   && insertData->prepare("INSERT INTO TilesData(id, Tile) VALUES(?, ?)");
+#ifdef DEBUG_PUREIMAGECACHE
+            if (!open) {
+                qDebug() << "Connection: " << db.lastError().driverText();
+            }
+#endif // DEBUG_PUREIMAGECACHE
+        }
+    }
+    ~Connection()
+    {
+        // all users of the connection have to be gone before it can be removed
+        delete select;
+        delete find;
+        delete insertTile;
+        delete insertData;
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+    bool IsOpen() const
+    {
+        return open;
+    }
+    QByteArray Get(MapType::Types type, const Point &pos, int zoom)
+    {
+        QByteArray ar;
+
+        bind(select, type, pos, zoom);
+        if (select->exec() && select->next()) {
+            ar = select->value(0).toByteArray();
+        }
+        // a statement that is not reset keeps its read transaction open
+        select->finish();
+        return ar;
+    }
+    // Must be called inside a transaction
+    bool Put(const QByteArray &tile, MapType::Types type, const Point &pos, int zoom, const QString &date)
+    {
+        bind(find, type, pos, zoom);
+        if (!find->exec()) {
+            return false;
+        }
+        bool exists = find->next();
+        find->finish();
+        if (exists) {
+            return true;
+        }
+        bind(insertTile, type, pos, zoom);
+        insertTile->bindValue(4, date);
+        if (!insertTile->exec()) {
+            return false;
+        }
+        insertData->bindValue(0, insertTile->lastInsertId());
+        insertData->bindValue(1, tile);
+        return insertData->exec();
+    }
+
+    QSqlDatabase db;
+    int generation;
+
+private:
+    static void bind(QSqlQuery *query, MapType::Types type, const Point &pos, int zoom)
+    {
+        query->bindValue(0, pos.X());
+        query->bindValue(1, pos.Y());
+        query->bindValue(2, zoom);
+        query->bindValue(3, (int)type);
+    }
+
+    QString name;
+    bool open;
+    QSqlQuery *select;
+    QSqlQuery *find;
+    QSqlQuery *insertTile;
+    QSqlQuery *insertData;
+};
+
+PureImageCache::PureImageCache() : generation(0)
+{}
+
+PureImageCache::~PureImageCache()
 {}
 
+QString PureImageCache::ConnectionName()
+{
+    QMutexLocker locker(&Mcounter);
+
+    return QString::number(++ConnCounter);
+}
+
+PureImageCache::Connection *PureImageCache::connection()
+{
+    // Must be called with the lock held
+    Connection *cn = connections.localData();
+
+    if (!cn || cn->generation != generation) {
+        // the cache moved, setLocalData() closes the old connection
+        cn = new Connection(gtilecache + "Data.qmdb", generation);
+        connections.setLocalData(cn);
+    }
+    return cn;
+}
+
 void PureImageCache::setGtileCache(const QString &value)
 {
     lock.lockForWrite();
     gtilecache = value;
+    ++generation;
     QDir d;
     if (!d.exists(gtilecache)) {
         d.mkdir(gtilecache);
@@ -52,6 +177,8 @@ void PureImageCache::setGtileCache(const QString &value)
             qDebug() << "Try to create EmptyDB";
 #endif // DEBUG_PUREIMAGECACHE
             CreateEmptyDB(db);
+        } else {
+            UpgradeDB(db);
         }
     }
     lock.unlock();
@@ -61,6 +188,30 @@ QString PureImageCache::GtileCache()
     return gtilecache;
 }
 
+bool PureImageCache::UpgradeDB(const QString &file)
+{
+    // Databases created by older versions have neither the index nor WAL
+    QString name = ConnectionName();
+    bool ret     = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(file);
+        if (db.open()) {
+            QSqlQuery query(db);
+            ret = query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)")
+                  && query.exec("PRAGMA journal_mode=WAL");
+#ifdef DEBUG_PUREIMAGECACHE
+            if (!ret) {
+                qDebug() << "UpgradeDB: " << query.lastError().driverText();
+            }
+#endif // DEBUG_PUREIMAGECACHE
+            query.clear();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return ret;
+}
 
 bool PureImageCache::CreateEmptyDB(const QString &file)
 {
@@ -101,6 +252,14 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     if (query.numRowsAffected() == -1) {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        db.close();
+        return false;
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+    if (query.numRowsAffected() == -1) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
 #endif // DEBUG_PUREIMAGECACHE
         db.close();
         return false;
@@ -154,130 +313,95 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
         db.close();
         return false;
     }
+    query.exec("PRAGMA journal_mode=WAL");
+    query.clear();
     db.close();
+    db = QSqlDatabase();
     QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
     return true;
 }
 bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
 {
+    CacheItemQueue item(type, pos, tile, zoom);
+
+    return PutImagesToCache(QList<CacheItemQueue *>() << &item);
+}
+bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue *> &tiles)
+{
+    QReadLocker locker(&lock);
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return false;
     }
-    lock.lockForRead();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "PutImageToCache Start:"; // <<pos;
+    qDebug() << "PutImagesToCache Start:" << tiles.count();
 #endif // DEBUG_PUREIMAGECACHE
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
-    {
-        QSqlDatabase cn;
-        cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-        QString db = gtilecache + "Data.qmdb";
-        cn.setDatabaseName(db);
-        cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (cn.open()) {
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                query.addBindValue(pos.X());
-                query.addBindValue(pos.Y());
-                query.addBindValue(zoom);
-
-                query.addBindValue((int)type);
-                query.addBindValue(QDateTime::currentDateTime().toString());
-                query.exec();
-            }
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                query.addBindValue(tile);
-                query.exec();
-            }
-            cn.close();
+    Connection *cn = connection();
+    if (!cn->IsOpen() || !cn->db.transaction()) {
+        return false;
+    }
+    QString date = QDateTime::currentDateTime().toString();
+    bool ret     = true;
+    foreach(CacheItemQueue * item, tiles) {
+        if (!cn->Put(item->GetImg(), item->GetMapType(), item->GetPosition(), item->GetZoom(), date)) {
+            ret = false;
+            break;
         }
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
-    lock.unlock();
-    return true;
+    if (ret) {
+        ret = cn->db.commit();
+    } else {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "PutImagesToCache: " << cn->db.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        cn->db.rollback();
+    }
+    return ret;
 }
 QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
 {
-    lock.lockForRead();
+    QReadLocker locker(&lock);
     QByteArray ar;
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return ar;
     }
-    QString dir  = gtilecache;
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "Cache dir=" << dir << " Try to GET:" << pos.X() + "," + pos.Y();
+    qDebug() << "Cache dir=" << gtilecache << " Try to GET:" << pos.X() << "," << pos.Y();
 #endif // DEBUG_PUREIMAGECACHE
-
-    {
-        QString db = dir + "Data.qmdb";
-        {
-            QSqlDatabase cn;
-
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int)type));
-                    query.next();
-                    if (query.isValid()) {
-                        ar = query.value(0).toByteArray();
-                    }
-                }
-                cn.close();
-            }
-        }
+    Connection *cn = connection();
+    if (cn->IsOpen()) {
+        ar = cn->Get(type, pos, zoom);
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
-    lock.unlock();
     return ar;
 }
 void PureImageCache::deleteOlderTiles(int const & days)
 {
+    QReadLocker locker(&lock);
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return;
     }
-    QList<long> add;
-    bool ret    = true;
-    QString dir = gtilecache;
-    {
-        QString db = dir + "Data.qmdb";
-        ret = QFileInfo(db).exists();
-        if (ret) {
-            QSqlDatabase cn;
-            Mcounter.lock();
-            qlonglong id = ++ConnCounter;
-            Mcounter.unlock();
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                    while (query.next()) {
-                        if (QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime()) > days) {
-                            add.append(query.value(0).toLongLong());
-                        }
-                    }
-                    foreach(long i, add) {
-                        query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                    }
+    QList<qlonglong> add;
+    Connection *cn = connection();
+    if (cn->IsOpen()) {
+        {
+            QSqlQuery query(cn->db);
+            query.exec(QString("SELECT id, Date FROM Tiles"));
+            while (query.next()) {
+                if (QDateTime::fromString(query.value(1).toString()).daysTo(QDateTime::currentDateTime()) > days) {
+                    add.append(query.value(0).toLongLong());
                 }
-
-                cn.close();
             }
-            QSqlDatabase::removeDatabase(QString::number(id));
+        }
+        if (!add.isEmpty() && cn->db.transaction()) {
+            QSqlQuery query(cn->db);
+            query.prepare("DELETE FROM Tiles WHERE id = ?");
+            foreach(qlonglong i, add) {
+                query.bindValue(0, i);
+                query.exec();
+            }
+            cn->db.commit();
         }
     }
 }
@@ -305,20 +429,34 @@ bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
         if (cb.open()) {
             QSqlQuery queryb(cb);
             queryb.exec(QString("ATTACH DATABASE \"%1\" AS Source").arg(sourceFile));
+            queryb.prepare("SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?");
             QSqlQuery querya(ca);
             querya.exec("SELECT id, X, Y, Zoom, Type, Date FROM Tiles");
             while (querya.next()) {
                 long id = querya.value(0).toLongLong();
-                queryb.exec(QString("SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4;").arg(querya.value(1).toLongLong()).arg(querya.value(2).toLongLong()).arg(querya.value(3).toLongLong()).arg(querya.value(4).toLongLong()));
+                for (int i = 0; i < 4; ++i) {
+                    queryb.bindValue(i, querya.value(i + 1));
+                }
+                queryb.exec();
                 if (!queryb.next()) {
                     add.append(id);
                 }
+                queryb.finish();
             }
+            // one transaction for all tiles instead of one per insert
+            cb.transaction();
+            QSqlQuery insertTile(cb);
+            QSqlQuery insertData(cb);
+            insertTile.prepare("INSERT INTO Tiles(X, Y, Zoom, Type, Date) SELECT X, Y, Zoom, Type, Date FROM Source.Tiles WHERE id=?");
+            insertData.prepare("INSERT INTO TilesData(id, Tile) Values((SELECT last_insert_rowid()), (SELECT Tile FROM Source.TilesData WHERE id=?))");
             long f;
             foreach(f, add) {
-                queryb.exec(QString("INSERT INTO Tiles(X, Y, Zoom, Type, Date) SELECT X, Y, Zoom, Type, Date FROM Source.Tiles WHERE id=%1").arg(f));
-                queryb.exec(QString("INSERT INTO TilesData(id, Tile) Values((SELECT last_insert_rowid()), (SELECT Tile FROM Source.TilesData WHERE id=%1))").arg(f));
+                insertTile.bindValue(0, (qlonglong)f);
+                insertTile.exec();
+                insertData.bindValue(0, (qlonglong)f);
+                insertData.exec();
             }
+            cb.commit();
             add.clear();
             ca.close();
             cb.close();
@@ -328,4 +466,132 @@ bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
     QSqlDatabase::removeDatabase("cb");
     return true;
 }
+bool PureImageCache::ExportToMBTiles(const QString &file, const MapType::Types &type)
+{
+    QReadLocker locker(&lock);
+
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        return false;
+    }
+    Connection *cn = connection();
+    if (!cn->IsOpen()) {
+        return false;
+    }
+    QString name = ConnectionName();
+    bool ret     = false;
+    {
+        QSqlDatabase mb = QSqlDatabase::addDatabase("QSQLITE", name);
+        mb.setDatabaseName(file);
+        if (mb.open()) {
+            QSqlQuery query(mb);
+            ret = query.exec("CREATE TABLE IF NOT EXISTS metadata (name TEXT, value TEXT)")
+                  && query.exec("CREATE UNIQUE INDEX IF NOT EXISTS name ON metadata (name)")
+                  && query.exec("CREATE TABLE IF NOT EXISTS tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)")
+                  && query.exec("CREATE UNIQUE INDEX IF NOT EXISTS tile_index ON tiles (zoom_level, tile_column, tile_row)")
+                  && mb.transaction();
+            if (ret) {
+                QSqlQuery source(cn->db);
+                source.setForwardOnly(true);
+                source.prepare("SELECT Tiles.X, Tiles.Y, Tiles.Zoom, TilesData.Tile FROM Tiles JOIN TilesData ON TilesData.id = Tiles.id WHERE Tiles.Type=?");
+                source.bindValue(0, (int)type);
+                ret = source.exec();
+                query.prepare("INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data) VALUES(?, ?, ?, ?)");
+                int minZoom = -1;
+                int maxZoom = -1;
+                QString format;
+                while (ret && source.next()) {
+                    int zoom = source.value(2).toInt();
+                    QByteArray tile = source.value(3).toByteArray();
+                    query.bindValue(0, zoom);
+                    query.bindValue(1, source.value(0));
+                    // MBTiles counts rows from the south like TMS does
+                    query.bindValue(2, (1 << zoom) - 1 - source.value(1).toInt());
+                    query.bindValue(3, tile);
+                    ret = query.exec();
+                    minZoom = (minZoom < 0) ? zoom : qMin(minZoom, zoom);
+                    maxZoom = qMax(maxZoom, zoom);
+                    if (format.isEmpty()) {
+                        format = tile.startsWith("\x89PNG") ? "png" : "jpg";
+                    }
+                }
+                source.finish();
+                QList<QPair<QString, QString> > metadata;
+                metadata << qMakePair(QString("name"), MapType::StrByType(type))
+                         << qMakePair(QString("type"), QString("baselayer"))
+                         << qMakePair(QString("version"), QString("1.1"))
+                         << qMakePair(QString("description"), QString("Exported from the OpenPilot GCS map cache"));
+                if (!format.isEmpty()) {
+                    metadata << qMakePair(QString("format"), format)
+                             << qMakePair(QString("minzoom"), QString::number(minZoom))
+                             << qMakePair(QString("maxzoom"), QString::number(maxZoom));
+                }
+                query.prepare("INSERT OR REPLACE INTO metadata (name, value) VALUES(?, ?)");
+                for (int i = 0; ret && i < metadata.count(); ++i) {
+                    query.bindValue(0, metadata.at(i).first);
+                    query.bindValue(1, metadata.at(i).second);
+                    ret = query.exec();
+                }
+                if (ret) {
+                    ret = mb.commit();
+                } else {
+                    mb.rollback();
+                }
+            }
+#ifdef DEBUG_PUREIMAGECACHE
+            if (!ret) {
+                qDebug() << "ExportToMBTiles: " << mb.lastError().driverText();
+            }
+#endif // DEBUG_PUREIMAGECACHE
+            query.clear();
+            mb.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return ret;
+}
+bool PureImageCache::ImportFromMBTiles(const QString &file, const MapType::Types &type)
+{
+    QReadLocker locker(&lock);
+
+    if (gtilecache.isEmpty() | gtilecache.isNull() || !QFileInfo(file).exists()) {
+        return false;
+    }
+    Connection *cn = connection();
+    if (!cn->IsOpen()) {
+        return false;
+    }
+    QString name = ConnectionName();
+    bool ret     = false;
+    {
+        QSqlDatabase mb = QSqlDatabase::addDatabase("QSQLITE", name);
+        mb.setDatabaseName(file);
+        if (mb.open()) {
+            QSqlQuery query(mb);
+            query.setForwardOnly(true);
+            ret = query.exec("SELECT zoom_level, tile_column, tile_row, tile_data FROM tiles") && cn->db.transaction();
+            if (ret) {
+                QString date = QDateTime::currentDateTime().toString();
+                while (ret && query.next()) {
+                    int zoom = query.value(0).toInt();
+                    Point pos(query.value(1).toInt(), (1 << zoom) - 1 - query.value(2).toInt());
+                    ret = cn->Put(query.value(3).toByteArray(), type, pos, zoom, date);
+                }
+                if (ret) {
+                    ret = cn->db.commit();
+                } else {
+                    cn->db.rollback();
+                }
+            }
+#ifdef DEBUG_PUREIMAGECACHE
+            if (!ret) {
+                qDebug() << "ImportFromMBTiles: " << query.lastError().driverText() << cn->db.lastError().driverText();
+            }
+#endif // DEBUG_PUREIMAGECACHE
+            query.clear();
+            mb.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return ret;
+}
 }
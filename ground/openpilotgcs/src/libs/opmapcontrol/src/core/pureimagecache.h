@@ -42,21 +42,44 @@
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
+#include "cacheitemqueue.h"
 namespace core {
 class PureImageCache {
 public:
     PureImageCache();
+    ~PureImageCache();
     static bool CreateEmptyDB(const QString &file);
     bool PutImageToCache(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+    /// <summary>
+    /// stores all tiles in one transaction, tiles that are already in the cache are skipped
+    /// </summary>
+    bool PutImagesToCache(const QList<CacheItemQueue *> &tiles);
     QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
     QString GtileCache();
     void setGtileCache(const QString &value);
     static bool ExportMapDataToDB(QString sourceFile, QString destFile);
+    /// <summary>
+    /// writes all cached tiles of a map type to an MBTiles file, existing tiles in the file are replaced
+    /// </summary>
+    bool ExportToMBTiles(const QString &file, const MapType::Types &type);
+    /// <summary>
+    /// adds the tiles of an MBTiles file to the cache as tiles of the given map type
+    /// </summary>
+    bool ImportFromMBTiles(const QString &file, const MapType::Types &type);
     void deleteOlderTiles(int const & days);
 private:
+    class Connection;
+    // Connections and their prepared statements can only be used by the thread
+    // that opened them, so every thread keeps its own
+    Connection *connection();
+    static bool UpgradeDB(const QString &file);
+    static QString ConnectionName();
     QString gtilecache;
-    QMutex Mcounter;
+    int generation;
     QReadWriteLock lock;
+    QThreadStorage<Connection *> connections;
+    static QMutex Mcounter;
     static qlonglong ConnCounter;
 };
 }
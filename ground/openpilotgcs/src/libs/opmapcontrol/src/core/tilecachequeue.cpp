@@ -30,7 +30,10 @@
 // #define DEBUG_TILECACHEQUEUE
 
 namespace core {
-TileCacheQueue::TileCacheQueue()
+// Tiles are written in batches, every batch is one transaction
+static const int CACHE_BATCH_SIZE = 64;
+
+TileCacheQueue::TileCacheQueue() : active(false)
 {}
 TileCacheQueue::~TileCacheQueue()
 {
@@ -42,25 +45,26 @@ void TileCacheQueue::EnqueueCacheTask(CacheItemQueue *task)
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "DB Do I EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
 #endif // DEBUG_TILECACHEQUEUE
+    QMutexLocker locker(&mutex);
+
     if (!tileCacheQueue.contains(task)) {
 #ifdef DEBUG_TILECACHEQUEUE
         qDebug() << "EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
 #endif // DEBUG_TILECACHEQUEUE
-        mutex.lock();
         tileCacheQueue.enqueue(task);
-        mutex.unlock();
-        if (this->isRunning()) {
+        if (active) {
 #ifdef DEBUG_TILECACHEQUEUE
             qDebug() << "Wake Thread";
 #endif // DEBUG_TILECACHEQUEUE
-            // this->start(QThread::NormalPriority);
-            // waitmutex.lock();
             waitc.wakeAll();
-            // waitmutex.unlock();
         } else {
 #ifdef DEBUG_TILECACHEQUEUE
             qDebug() << "Start Thread";
 #endif // DEBUG_TILECACHEQUEUE
+            active = true;
+            locker.unlock();
+            // a thread that just timed out may still be returning from run()
+            wait();
             this->start(QThread::NormalPriority);
         }
     }
@@ -71,39 +75,31 @@ void TileCacheQueue::run()
     qDebug() << "Cache Engine Start";
 #endif // DEBUG_TILECACHEQUEUE
     while (true) {
-        CacheItemQueue *task;
-#ifdef DEBUG_TILECACHEQUEUE
-        qDebug() << "Cache";
-#endif // DEBUG_TILECACHEQUEUE
-        if (tileCacheQueue.count() > 0) {
-            mutex.lock();
-            task = tileCacheQueue.dequeue();
-            mutex.unlock();
+        QList<CacheItemQueue *> batch;
+        {
+            QMutexLocker locker(&mutex);
+            if (tileCacheQueue.isEmpty()) {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Cache engine Put:" << task->GetPosition().X() << "," << task->GetPosition().Y();
+                qDebug() << "Cache engine BEGIN WAIT";
 #endif // DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(), task->GetMapType(), task->GetPosition(), task->GetZoom());
-            usleep(44);
-            delete task;
-        } else {
-            qDebug() << "Cache engine BEGIN WAIT";
-            waitmutex.lock();
-            int tout = 4000;
-            if (!waitc.wait(&waitmutex, tout)) {
-                waitmutex.unlock();
+                waitc.wait(&mutex, 4000);
+                if (tileCacheQueue.isEmpty()) {
 #ifdef DEBUG_TILECACHEQUEUE
-                qDebug() << "Cache Engine TimeOut";
+                    qDebug() << "Cache Engine TimeOut";
 #endif // DEBUG_TILECACHEQUEUE
-                mutex.lock();
-                if (tileCacheQueue.count() == 0) {
-                    mutex.unlock();
+                    active = false;
                     break;
                 }
-                mutex.unlock();
             }
-            qDebug() << "Cache Engine DID NOT TimeOut";
-            waitmutex.unlock();
+            while (!tileCacheQueue.isEmpty() && batch.count() < CACHE_BATCH_SIZE) {
+                batch.append(tileCacheQueue.dequeue());
+            }
         }
+#ifdef DEBUG_TILECACHEQUEUE
+        qDebug() << "Cache engine Put:" << batch.count();
+#endif // DEBUG_TILECACHEQUEUE
+        Cache::Instance()->ImageCache.PutImagesToCache(batch);
+        qDeleteAll(batch);
     }
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "Cache Engine Stopped";
@@ -51,8 +51,8 @@ protected:
 private:
     void run();
     QMutex mutex;
-    QMutex waitmutex;
     QWaitCondition waitc;
+    bool active;
 };
 }
 #endif // TILECACHEQUEUE_H
@@ -0,0 +1,281 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilefetcher.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Shared asynchronous downloader for map tiles
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tilefetcher.h"
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QMutexLocker>
+#include <QTime>
+
+
+namespace core {
+// QNetworkAccessManager opens up to 6 connections per host, with pipelining
+// every connection carries several requests
+static const int DEFAULT_MAX_REQUESTS = 24;
+
+TileFetcher::TileFetcher() : network(0), proxyChanged(false), maxRequests(DEFAULT_MAX_REQUESTS), sharedRequests(0), cancelledRequests(0)
+{
+    moveToThread(&thread);
+    thread.start();
+}
+
+TileFetcher::~TileFetcher()
+{
+    // nobody must be left waiting, whoever asked for it
+    cancelRequests(-1, QList<core::Point>(), true);
+    thread.quit();
+    thread.wait();
+    delete network;
+}
+
+QByteArray TileFetcher::Fetch(const RawTile &tile, const QNetworkRequest &request, int timeout, Result *result, bool cancellable)
+{
+    QMutexLocker lock(&mutex);
+    Request *r = requests.value(tile, 0);
+
+    if (r) {
+        // somebody is downloading this tile already, wait for the same reply
+        ++sharedRequests;
+    } else {
+        r = new Request(tile);
+        r->request = request;
+        requests.insert(tile, r);
+        pending.enqueue(r);
+        QMetaObject::invokeMethod(this, "startRequests", Qt::QueuedConnection);
+    }
+    ++r->waiters;
+    r->cancellable &= cancellable;
+
+    QTime time;
+    time.start();
+    while (!r->done) {
+        int left = timeout - time.elapsed();
+        if (left <= 0 || !finished.wait(&mutex, left)) {
+            break;
+        }
+    }
+
+    Result res = r->done ? r->result : Timeout;
+    QByteArray data;
+    if (res == Ok) {
+        data = r->data;
+    }
+
+    // nobody else waits for a tile that timed out, stop downloading it
+    bool abort = false;
+    if (!r->done && r->waiters == 1) {
+        abort = cancel(r);
+    }
+    release(r);
+    lock.unlock();
+
+    if (abort) {
+        QMetaObject::invokeMethod(this, "abortCancelled", Qt::QueuedConnection);
+    }
+    if (result) {
+        *result = res;
+    }
+    return data;
+}
+
+void TileFetcher::CancelTilesNotIn(int zoom, const QList<core::Point> &keep)
+{
+    cancelRequests(zoom, keep, false);
+}
+
+void TileFetcher::CancelAll()
+{
+    cancelRequests(-1, QList<core::Point>(), false);
+}
+
+void TileFetcher::cancelRequests(int zoom, const QList<core::Point> &keep, bool force)
+{
+    bool abort = false;
+    {
+        QMutexLocker lock(&mutex);
+        QList<Request *> all = requests.values();
+        foreach(Request * r, all) {
+            RawTile tile = r->tile;
+
+            if ((!r->cancellable && !force) || (tile.Zoom() == zoom && keep.contains(tile.Pos()))) {
+                continue;
+            }
+            ++cancelledRequests;
+            abort |= cancel(r);
+        }
+    }
+    if (abort) {
+        QMetaObject::invokeMethod(this, "abortCancelled", Qt::QueuedConnection);
+    }
+}
+
+void TileFetcher::SetProxy(const QNetworkProxy &value)
+{
+    QMutexLocker lock(&mutex);
+
+    if (!(proxy == value)) {
+        proxy = value;
+        proxyChanged = true;
+    }
+}
+
+void TileFetcher::SetMaxRequests(int value)
+{
+    {
+        QMutexLocker lock(&mutex);
+        maxRequests = qMax(1, value);
+    }
+    QMetaObject::invokeMethod(this, "startRequests", Qt::QueuedConnection);
+}
+
+int TileFetcher::RequestsInFlight()
+{
+    QMutexLocker lock(&mutex);
+
+    return replies.count() + pending.count();
+}
+
+int TileFetcher::SharedRequests()
+{
+    QMutexLocker lock(&mutex);
+
+    return sharedRequests;
+}
+
+int TileFetcher::CancelledRequests()
+{
+    QMutexLocker lock(&mutex);
+
+    return cancelledRequests;
+}
+
+void TileFetcher::startRequests()
+{
+    // the manager has to live in the fetcher thread
+    if (!network) {
+        network = new QNetworkAccessManager();
+    }
+
+    QMutexLocker lock(&mutex);
+    if (proxyChanged) {
+        network->setProxy(proxy);
+        proxyChanged = false;
+    }
+    while (replies.count() < maxRequests && !pending.isEmpty()) {
+        Request *r = pending.dequeue();
+        QNetworkRequest request = r->request;
+        request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+        r->reply = network->get(request);
+        replies.insert(r->reply, r);
+        connect(r->reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+    }
+}
+
+void TileFetcher::abortCancelled()
+{
+    QList<QNetworkReply *> cancelled;
+    {
+        QMutexLocker lock(&mutex);
+        QHash<QNetworkReply *, Request *>::const_iterator i;
+        for (i = replies.constBegin(); i != replies.constEnd(); ++i) {
+            if (i.value()->cancelled) {
+                cancelled.append(i.key());
+            }
+        }
+    }
+    // abort() emits finished() right away, which needs the mutex
+    foreach(QNetworkReply * reply, cancelled) {
+        reply->abort();
+    }
+}
+
+void TileFetcher::replyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+
+    if (!reply) {
+        return;
+    }
+    {
+        QMutexLocker lock(&mutex);
+        Request *r = replies.take(reply);
+        if (r) {
+            r->reply = 0;
+            if (r->done) {
+                // cancelled, drop the reference finish() took for the reply
+                release(r);
+            } else if (reply->error() != QNetworkReply::NoError) {
+                finish(r, NetworkError);
+            } else {
+                r->data = reply->readAll();
+                finish(r, Ok);
+            }
+        }
+    }
+    reply->deleteLater();
+    startRequests();
+}
+
+bool TileFetcher::cancel(Request *r)
+{
+    // Must be called with the mutex held, returns true if a reply needs to be aborted
+    if (r->done || r->cancelled) {
+        return false;
+    }
+    bool running = (r->reply != 0);
+    if (!running) {
+        pending.removeOne(r);
+    }
+    r->cancelled = true;
+    finish(r, Cancelled);
+    return running;
+}
+
+void TileFetcher::finish(Request *r, Result result)
+{
+    r->done   = true;
+    r->result = result;
+    // later requests for the same tile start a new download
+    if (requests.value(r->tile, 0) == r) {
+        requests.remove(r->tile);
+    }
+    // the reply holds a reference until it has finished
+    if (r->reply) {
+        ++r->waiters;
+    }
+    finished.wakeAll();
+    if (!r->waiters) {
+        delete r;
+    }
+}
+
+void TileFetcher::release(Request *r)
+{
+    if (--r->waiters == 0 && r->done) {
+        delete r;
+    }
+}
+}
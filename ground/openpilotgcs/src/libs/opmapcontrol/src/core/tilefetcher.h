@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilefetcher.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Shared asynchronous downloader for map tiles
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEFETCHER_H
+#define TILEFETCHER_H
+
+#include "rawtile.h"
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QQueue>
+#include <QList>
+#include <QByteArray>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkProxy>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace core {
+/**
+ * Downloads tiles through one QNetworkAccessManager running in its own thread,
+ * so that HTTP connections are kept alive and requests can be pipelined.
+ * Any thread may call Fetch(); concurrent requests for the same tile share a
+ * single download, and requests for tiles that are no longer needed can be
+ * cancelled, which wakes their callers right away. Downloads that somebody
+ * fetches as not cancellable are left alone by the Cancel functions.
+ */
+class TileFetcher : public QObject {
+    Q_OBJECT
+public:
+    enum Result {
+        Ok,
+        NetworkError,
+        Timeout,
+        Cancelled
+    };
+
+    TileFetcher();
+    ~TileFetcher();
+
+    /**
+     * Downloads a tile, blocking the calling thread until it arrived, failed,
+     * timed out after timeout milliseconds or was cancelled.
+     */
+    QByteArray Fetch(const RawTile &tile, const QNetworkRequest &request, int timeout, Result *result = 0, bool cancellable = true);
+
+    /**
+     * Cancels all cancellable requests that are not for one of the positions in keep at the given zoom.
+     */
+    void CancelTilesNotIn(int zoom, const QList<core::Point> &keep);
+    void CancelAll();
+
+    void SetProxy(const QNetworkProxy &proxy);
+    void SetMaxRequests(int value);
+
+    int RequestsInFlight();
+    int SharedRequests();
+    int CancelledRequests();
+
+private slots:
+    void startRequests();
+    void abortCancelled();
+    void replyFinished();
+
+private:
+    struct Request {
+        Request(const RawTile &Tile) : tile(Tile), reply(0), result(Ok), waiters(0), done(false), cancelled(false), cancellable(true) {}
+        RawTile tile;
+        QNetworkRequest request;
+        QNetworkReply *reply;
+        QByteArray data;
+        Result result;
+        int  waiters;
+        bool done;
+        bool cancelled;
+        bool cancellable; // false once any waiter must not be cancelled
+    };
+
+    void cancelRequests(int zoom, const QList<core::Point> &keep, bool force);
+    bool cancel(Request *r);
+    void finish(Request *r, Result result);
+    void release(Request *r);
+
+    QThread thread;
+    QNetworkAccessManager *network;
+    QNetworkProxy proxy;
+    bool proxyChanged;
+    QMutex mutex;
+    QWaitCondition finished;
+    QHash<RawTile, Request *> requests;
+    QQueue<Request *> pending;
+    QHash<QNetworkReply *, Request *> replies;
+    int maxRequests;
+    int sharedRequests;
+    int cancelledRequests;
+};
+}
+#endif // TILEFETCHER_H
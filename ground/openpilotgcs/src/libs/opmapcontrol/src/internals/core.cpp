@@ -97,7 +97,8 @@ void Core::run()
                 {
                     Tile *m = Matrix.TileAt(task.Pos);
 
-                    if (m == 0 || m->Overlays.count() == 0) {
+                    // tiles that scrolled out of view meanwhile are not loaded
+                    if ((m == 0 || m->Overlays.count() == 0) && IsTileWanted(task)) {
 #ifdef DEBUG_CORE
                         qDebug() << "Fill empty TileMatrix: " + task.ToString() << " ID=" << debug;;
 #endif // DEBUG_CORE
@@ -109,31 +110,33 @@ void Core::run()
                             int retry = 0;
 
                             do {
-                                QByteArray img;
+                                QImage img;
 
                                 // tile number inversion(BottomLeft -> TopLeft) for pergo maps
                                 if (tl == MapType::PergoTurkeyMap) {
-                                    img = OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
+                                    img = OPMaps::Instance()->GetDecodedImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
                                 } else { // ok
 #ifdef DEBUG_CORE
                                     qDebug() << "start getting image" << " ID=" << debug;
 #endif // DEBUG_CORE
-                                    img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                                    img = OPMaps::Instance()->GetDecodedImageFrom(tl, task.Pos, task.Zoom);
 #ifdef DEBUG_CORE
-                                    qDebug() << "Core::run:gotimage size:" << img.count() << " ID=" << debug << " time=" << t.elapsed();
+                                    qDebug() << "Core::run:gotimage size:" << img.byteCount() << " ID=" << debug << " time=" << t.elapsed();
 #endif // DEBUG_CORE
                                 }
 
-                                if (img.length() != 0) {
+                                if (!img.isNull()) {
                                     Moverlays.lock();
                                     {
                                         t->Overlays.append(img);
 #ifdef DEBUG_CORE
-                                        qDebug() << "Core::run append img:" << img.length() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
+                                        qDebug() << "Core::run append img:" << img.byteCount() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
 #endif // DEBUG_CORE
                                     }
                                     Moverlays.unlock();
 
+                                    break;
+                                } else if (!IsTileWanted(task)) {
                                     break;
                                 } else if (OPMaps::Instance()->RetryLoadTile > 0) {
 #ifdef DEBUG_CORE
@@ -173,10 +176,6 @@ void Core::run()
                 {
                     // last buddy cleans stuff ;}
                     if (last) {
-                        OPMaps::Instance()->kiberCacheLock.lockForWrite();
-                        OPMaps::Instance()->TilesInMemory.RemoveMemoryOverload();
-                        OPMaps::Instance()->kiberCacheLock.unlock();
-
                         MtileDrawingList.lock();
                         {
                             Matrix.ClearPointsNotIn(tileDrawingList);
@@ -202,6 +201,13 @@ void Core::run()
     --runningThreads;
     MrunningThreads.unlock();
 }
+bool Core::IsTileWanted(const LoadTask &task)
+{
+    QMutexLocker lock(&MtileDrawingList);
+
+    return task.Zoom == Zoom() && tileDrawingList.contains(task.Pos);
+}
+
 diagnostics Core::GetDiagnostics()
 {
     MrunningThreads.lock();
@@ -539,6 +545,8 @@ void Core::Drag(Point const & pt)
 void Core::CancelAsyncTasks()
 {
     if (started) {
+        // wake the loaders waiting for downloads
+        OPMaps::Instance()->CancelAllTiles();
         ProcessLoadTaskCallback.waitForDone();
         MtileLoadQueue.lock();
         {
@@ -564,6 +572,16 @@ void Core::UpdateBounds()
 
         emit OnTileLoadStart();
 
+        // stop downloading tiles that are not needed anymore
+        if (GetMapType() == MapType::PergoTurkeyMap) {
+            QList<Point> requested;
+            foreach(Point p, tileDrawingList) {
+                requested.append(Point(p.X(), maxOfTiles.Height() - p.Y()));
+            }
+            OPMaps::Instance()->CancelTilesNotIn(Zoom(), requested);
+        } else {
+            OPMaps::Instance()->CancelTilesNotIn(Zoom(), tileDrawingList);
+        }
 
         foreach(Point p, tileDrawingList) {
             LoadTask task = LoadTask(p, Zoom());
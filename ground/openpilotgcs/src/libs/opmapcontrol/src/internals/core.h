@@ -294,6 +294,8 @@ public:
 
     void FindTilesAround(QList<core::Point> &list);
 
+    bool IsTileWanted(const LoadTask &task);
+
     void UpdateGroundResolution();
 
     TileMatrix Matrix;
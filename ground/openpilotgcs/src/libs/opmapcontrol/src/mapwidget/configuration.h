@@ -184,6 +184,30 @@ public:
     {
         core::PureImageCache::ExportMapDataToDB(sourceDB, destDB);
     }
+
+    /**
+     * @brief  Exports the cached tiles of a map type to an MBTiles file
+     *
+     * @param file the MBTiles file. If it doesnt exhist it will be created.
+     * @param type the map type of the exported tiles
+     * @return true on success
+     */
+    bool ExportToMBTiles(QString const & file, core::MapType::Types const & type) const
+    {
+        return core::Cache::Instance()->ImageCache.ExportToMBTiles(file, type);
+    }
+
+    /**
+     * @brief  Imports the tiles of an MBTiles file into the cache. Only new tiles are added.
+     *
+     * @param file the MBTiles file
+     * @param type the map type the tiles are stored as
+     * @return true on success
+     */
+    bool ImportFromMBTiles(QString const & file, core::MapType::Types const & type) const
+    {
+        return core::Cache::Instance()->ImageCache.ImportFromMBTiles(file, type);
+    }
     /**
      * @brief Returns the location for the SQLite Database used for caching and the geocoding cache files
      *
@@ -316,13 +316,13 @@ void MapGraphicItem::DrawMap2D(QPainter *painter)
                         // render tile
                         // lock(t.Overlays)
                         if (t != 0) {
-                            foreach(QByteArray img, t->Overlays) {
-                                if (img.count() != 0) {
+                            foreach(QImage img, t->Overlays) {
+                                if (!img.isNull()) {
                                     if (!found) {
                                         found = true;
                                     }
                                     {
-                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), PureImageProxy::FromStream(img));
+                                        painter->drawImage(QRect(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height()), img);
                                     }
                                 }
                             }
@@ -381,6 +381,15 @@ core::Point MapGraphicItem::FromLatLngToLocal(internals::PointLatLng const & poi
     }
     return ret;
 }
+QTransform MapGraphicItem::FromPixelToLocal()
+{
+    // Same as FromLatLngToLocal(), without the rounding
+    core::Point offset = core->GetrenderOffset();
+    qreal dx = offset.X() * MapRenderTransform - ((boundingRect().width() * MapRenderTransform) - (boundingRect().width())) / 2;
+    qreal dy = offset.Y() * MapRenderTransform - ((boundingRect().height() * MapRenderTransform) - (boundingRect().height())) / 2;
+
+    return QTransform(MapRenderTransform, 0, 0, MapRenderTransform, dx, dy);
+}
 internals::PointLatLng MapGraphicItem::FromLocalToLatLng(int x, int y)
 {
     if (MapRenderTransform != 1) {
@@ -84,6 +84,21 @@ public:
      * @return internals::PointLatLng LatLng coordinate
      */
     internals::PointLatLng FromLocalToLatLng(int x, int y);
+    /**
+     * @brief Returns the transformation from map pixel coordinates at PixelZoom() to local item coordinates
+     *
+     * @return QTransform valid until the map is moved or zoomed
+     */
+    QTransform FromPixelToLocal();
+    /**
+     * @brief Returns the zoom step the map pixel coordinates are computed for
+     *
+     * @return int
+     */
+    int PixelZoom() const
+    {
+        return core->Zoom();
+    }
     /**
      * @brief Returns true if map is being dragged
      *
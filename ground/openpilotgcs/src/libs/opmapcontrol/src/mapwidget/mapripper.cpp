@@ -108,7 +108,8 @@ void MapRipper::run()
             // qDebug()<<"offline fetching:"<<p.ToString();
             foreach(core::MapType::Types type, types) {
                 emit providerChanged(core::MapType::StrByType(type), zoom);
-                QByteArray img = OPMaps::Instance()->GetImageFrom(type, p, zoom);
+                // the map view must not cancel what is being ripped
+                QByteArray img = OPMaps::Instance()->GetImageFrom(type, p, zoom, false);
 
                 if (img.length() != 0) {
                     goodtile = true;
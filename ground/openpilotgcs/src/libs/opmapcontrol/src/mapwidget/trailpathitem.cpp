@@ -0,0 +1,249 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      A graphicsItem representing a UAV or GPS trail
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "trailpathitem.h"
+#include <QGraphicsSceneHoverEvent>
+#include <math.h>
+
+namespace mapcontrol {
+// Points collected before they are simplified as one stretch of the trail
+static const int SEGMENT_POINTS     = 32;
+static const int DEFAULT_MAX_POINTS = 5000;
+static const double EARTH_RADIUS_M  = 6378137.0;
+
+TrailPathItem::TrailPathItem(QColor const & pointColor, QColor const & lineColor, MapGraphicItem *map) : QGraphicsItem(map), m_map(map), m_pointColor(pointColor), m_lineColor(lineColor),
+    showPoints(true), showLine(true), tolerance(2), points(DEFAULT_MAX_POINTS), zoom(map->PixelZoom())
+{
+    setAcceptHoverEvents(true);
+    setAcceptedMouseButtons(Qt::NoButton);
+    setTransform(m_map->FromPixelToLocal());
+    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    connect(map, SIGNAL(zoomChanged(double, double, double)), this, SLOT(RefreshPos()));
+}
+
+void TrailPathItem::AddPoint(internals::PointLatLng const & coord, int const & altitude)
+{
+    TrailPoint p;
+
+    p.coord    = coord;
+    p.altitude = altitude;
+    p.time     = QDateTime::currentDateTime();
+    p.pixel    = toPixel(coord);
+    pending.append(p);
+    if (pending.count() >= SEGMENT_POINTS) {
+        simplify();
+    }
+    updatePath();
+}
+
+void TrailPathItem::Clear()
+{
+    points.clear();
+    pending.clear();
+    updatePath();
+}
+
+void TrailPathItem::SetMaxPoints(int const & value)
+{
+    // the newest points are kept
+    points.setCapacity(qMax(2, value));
+    updatePath();
+}
+
+void TrailPathItem::SetShowPoints(bool const & value)
+{
+    showPoints = value;
+    update();
+}
+
+void TrailPathItem::SetShowLine(bool const & value)
+{
+    showLine = value;
+    update();
+}
+
+void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    // the item is scaled with the map, cosmetic pens keep their width on screen
+    if (showLine && path.count() > 1) {
+        QPen pen(m_lineColor);
+        pen.setWidth(1);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->drawPolyline(path);
+    }
+    if (showPoints && !path.isEmpty()) {
+        QPen pen(m_pointColor);
+        pen.setWidth(4);
+        pen.setCapStyle(Qt::RoundCap);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->drawPoints(path);
+    }
+}
+
+QRectF TrailPathItem::boundingRect() const
+{
+    return bounds;
+}
+
+int TrailPathItem::type() const
+{
+    return Type;
+}
+
+void TrailPathItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    QPointF pos     = event->pos();
+    qreal radius    = 4 / qMax((qreal)1, transform().m11());
+    const TrailPoint *found = 0;
+
+    for (int i = points.firstIndex(); i <= points.lastIndex(); ++i) {
+        const TrailPoint &p = points.at(i);
+        if (qAbs(p.pixel.x() - pos.x()) <= radius && qAbs(p.pixel.y() - pos.y()) <= radius) {
+            found = &p;
+        }
+    }
+    for (int i = 0; i < pending.count(); ++i) {
+        const TrailPoint &p = pending.at(i);
+        if (qAbs(p.pixel.x() - pos.x()) <= radius && qAbs(p.pixel.y() - pos.y()) <= radius) {
+            found = &p;
+        }
+    }
+    if (found) {
+        QString coord_str = " " + QString::number(found->coord.Lat(), 'f', 6) + "   " + QString::number(found->coord.Lng(), 'f', 6);
+        setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str).arg(QString::number(found->altitude)).arg(found->time.toString()));
+    } else {
+        setToolTip(QString());
+    }
+    QGraphicsItem::hoverMoveEvent(event);
+}
+
+void TrailPathItem::RefreshPos()
+{
+    if (zoom != m_map->PixelZoom()) {
+        // the only time the whole trail is projected again
+        zoom = m_map->PixelZoom();
+        for (int i = points.firstIndex(); i <= points.lastIndex(); ++i) {
+            points[i].pixel = toPixel(points.at(i).coord);
+        }
+        for (int i = 0; i < pending.count(); ++i) {
+            pending[i].pixel = toPixel(pending.at(i).coord);
+        }
+        updatePath();
+    }
+    setTransform(m_map->FromPixelToLocal());
+}
+
+void TrailPathItem::simplify()
+{
+    // The last simplified point anchors the new stretch to the trail
+    QList<TrailPoint> segment;
+
+    if (!points.isEmpty()) {
+        segment.append(points.last());
+    }
+    segment += pending;
+    pending.clear();
+
+    QList<bool> keep;
+    for (int i = 0; i < segment.count(); ++i) {
+        keep.append(false);
+    }
+    keep.first() = true;
+    keep.last()  = true;
+    simplify(segment, 0, segment.count() - 1, keep);
+
+    for (int i = points.isEmpty() ? 0 : 1; i < segment.count(); ++i) {
+        if (keep.at(i)) {
+            points.append(segment.at(i));
+        }
+    }
+    if (!points.areIndexesValid()) {
+        points.normalizeIndexes();
+    }
+}
+
+void TrailPathItem::simplify(const QList<TrailPoint> &segment, int first, int last, QList<bool> &keep) const
+{
+    double maxDistance = 0;
+    int index = -1;
+
+    for (int i = first + 1; i < last; ++i) {
+        double distance = distanceToLine(segment.at(i), segment.at(first), segment.at(last));
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            index = i;
+        }
+    }
+    if (index >= 0 && maxDistance > tolerance) {
+        keep[index] = true;
+        simplify(segment, first, index, keep);
+        simplify(segment, index, last, keep);
+    }
+}
+
+double TrailPathItem::distanceToLine(const TrailPoint &p, const TrailPoint &a, const TrailPoint &b) const
+{
+    // Distance in meters from p to the line a-b, the stretches are short enough to treat them as flat
+    double k  = cos(a.coord.Lat() * M_PI / 180);
+    double bx = (b.coord.Lng() - a.coord.Lng()) * k;
+    double by = b.coord.Lat() - a.coord.Lat();
+    double px = (p.coord.Lng() - a.coord.Lng()) * k;
+    double py = p.coord.Lat() - a.coord.Lat();
+    double length2 = bx * bx + by * by;
+    double t  = (length2 > 0) ? qBound(0.0, (px * bx + py * by) / length2, 1.0) : 0;
+    double dx = px - t * bx;
+    double dy = py - t * by;
+
+    return sqrt(dx * dx + dy * dy) * M_PI / 180 * EARTH_RADIUS_M;
+}
+
+QPointF TrailPathItem::toPixel(internals::PointLatLng const & coord) const
+{
+    core::Point p = m_map->Projection()->FromLatLngToPixel(coord, zoom);
+
+    return QPointF(p.X(), p.Y());
+}
+
+void TrailPathItem::updatePath()
+{
+    prepareGeometryChange();
+    path.clear();
+    path.reserve(Count());
+    for (int i = points.firstIndex(); i <= points.lastIndex(); ++i) {
+        path.append(points.at(i).pixel);
+    }
+    foreach(const TrailPoint &p, pending) {
+        path.append(p.pixel);
+    }
+    // room for the dots
+    bounds = path.isEmpty() ? QRectF() : path.boundingRect().adjusted(-3, -3, 3, 3);
+}
+}
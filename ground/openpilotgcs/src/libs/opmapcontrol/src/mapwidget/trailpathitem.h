@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      A graphicsItem representing a UAV or GPS trail
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QContiguousCache>
+#include <QDateTime>
+#include <QList>
+#include "../internals/pointlatlng.h"
+#include <QObject>
+#include "mapgraphicitem.h"
+
+namespace mapcontrol {
+/**
+ * @brief The whole trail of a UAV or GPS as one item, drawn as dots and a line
+ *
+ * At most MaxPoints() points are kept, the oldest ones are dropped. New points are
+ * collected until a stretch of the trail is complete, which is then simplified
+ * (Douglas-Peucker) so that straight legs only keep their ends. The pixel coordinates
+ * of the points are cached for the current zoom step; panning only changes the item
+ * transformation.
+ *
+ * @class TrailPathItem trailpathitem.h "mapwidget/trailpathitem.h"
+ */
+class TrailPathItem : public QObject, public QGraphicsItem {
+    Q_OBJECT Q_INTERFACES(QGraphicsItem)
+public:
+    enum { Type = UserType + 5 };
+    TrailPathItem(QColor const & pointColor, QColor const & lineColor, MapGraphicItem *map);
+    /**
+     * @brief Adds a point to the end of the trail
+     *
+     * @param coord LatLng point
+     * @param altitude altitude in meters
+     */
+    void AddPoint(internals::PointLatLng const & coord, int const & altitude);
+    /**
+     * @brief Deletes all the trail points
+     */
+    void Clear();
+    /**
+     * @brief Sets the maximum number of points kept after simplification
+     *
+     * @param value
+     */
+    void SetMaxPoints(int const & value);
+    int MaxPoints() const
+    {
+        return points.capacity();
+    }
+    /**
+     * @brief Returns the number of points in the trail
+     *
+     * @return int
+     */
+    int Count() const
+    {
+        return points.count() + pending.count();
+    }
+    /**
+     * @brief Sets the distance in meters a point may be off a straight line and still be dropped
+     *
+     * @param value
+     */
+    void SetTolerance(double const & value)
+    {
+        tolerance = value;
+    }
+    void SetShowPoints(bool const & value);
+    void SetShowLine(bool const & value);
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+    QRectF boundingRect() const;
+    int type() const;
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+private:
+    struct TrailPoint {
+        internals::PointLatLng coord;
+        int altitude;
+        QDateTime time;
+        QPointF pixel;
+    };
+    void simplify();
+    void simplify(const QList<TrailPoint> &segment, int first, int last, QList<bool> &keep) const;
+    double distanceToLine(const TrailPoint &p, const TrailPoint &a, const TrailPoint &b) const;
+    QPointF toPixel(internals::PointLatLng const & coord) const;
+    void updatePath();
+
+    MapGraphicItem *m_map;
+    QColor m_pointColor;
+    QColor m_lineColor;
+    bool showPoints;
+    bool showLine;
+    double tolerance;
+    // simplified points, and the newest points that are not simplified yet
+    QContiguousCache<TrailPoint> points;
+    QList<TrailPoint> pending;
+    // zoom step the pixel coordinates were computed for
+    int zoom;
+    QPolygonF path;
+    QRectF bounds;
+public slots:
+    void RefreshPos();
+};
+}
+#endif // TRAILPATHITEM_H
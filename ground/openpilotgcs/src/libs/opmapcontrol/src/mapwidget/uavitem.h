@@ -38,8 +38,7 @@
 #include "uavtrailtype.h"
 #include <QtSvg/QSvgRenderer>
 #include "opmapwidget.h"
-#include "trailitem.h"
-#include "traillineitem.h"
+#include "trailpathitem.h"
 namespace mapcontrol {
 class WayPointItem;
 class OPMapWidget;
@@ -282,9 +281,7 @@ private:
     double ringTime;
     QPixmap pic;
     core::Point localposition;
-    QGraphicsItemGroup *trail;
-    QGraphicsItemGroup *trailLine;
-    internals::PointLatLng lasttrailline;
+    TrailPathItem *trail;
     QTime timer;
     bool showtrail;
     bool showtrailline;
@@ -309,8 +306,6 @@ public slots:
 signals:
     void UAVReachedWayPoint(int const & waypointnumber, WayPointItem *waypoint);
     void UAVLeftSafetyBouble(internals::PointLatLng const & position);
-    void setChildPosition();
-    void setChildLine();
 };
 }
 #endif // UAVITEM_H
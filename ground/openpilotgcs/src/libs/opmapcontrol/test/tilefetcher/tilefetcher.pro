@@ -0,0 +1,17 @@
+QT -= gui
+QT += network testlib
+TARGET = tst_tilefetcher
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+CORE = ../../src/core
+INCLUDEPATH += $$CORE
+
+SOURCES += tst_tilefetcher.cpp \
+    $$CORE/tilefetcher.cpp \
+    $$CORE/rawtile.cpp \
+    $$CORE/point.cpp \
+    $$CORE/size.cpp
+HEADERS += $$CORE/tilefetcher.h \
+    $$CORE/maptype.h
@@ -0,0 +1,324 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_tilefetcher.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Tests for the map tile fetcher
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "tilefetcher.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtTest/QtTest>
+
+using namespace core;
+
+static const int ZOOM = 10;
+
+/**
+ * Minimal HTTP/1.1 tile server. Answers requests in order, also when they are
+ * pipelined. Paths starting with /slow/ are answered after 200ms, paths
+ * starting with /hang/ are never answered.
+ */
+class StubTileServer : public QObject {
+    Q_OBJECT
+
+public:
+    StubTileServer() : server(0), port(0), served(0), connections(0) {}
+
+    quint16 Port()
+    {
+        QMutexLocker lock(&mutex);
+
+        return port;
+    }
+
+    int Served()
+    {
+        QMutexLocker lock(&mutex);
+
+        return served;
+    }
+
+    int Connections()
+    {
+        QMutexLocker lock(&mutex);
+
+        return connections;
+    }
+
+public slots:
+    void listen()
+    {
+        server = new QTcpServer(this);
+        connect(server, SIGNAL(newConnection()), this, SLOT(accept()));
+        server->listen(QHostAddress::LocalHost);
+        QMutexLocker lock(&mutex);
+        port = server->serverPort();
+    }
+
+    void close()
+    {
+        delete server;
+        server = 0;
+    }
+
+private slots:
+    void accept()
+    {
+        while (server->hasPendingConnections()) {
+            QTcpSocket *socket = server->nextPendingConnection();
+            connect(socket, SIGNAL(readyRead()), this, SLOT(read()));
+            connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+            QMutexLocker lock(&mutex);
+            ++connections;
+        }
+    }
+
+    void read()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+        QByteArray &buffer = buffers[socket];
+
+        buffer += socket->readAll();
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) >= 0) {
+            QByteArray path = buffer.left(end).split(' ').value(1);
+            buffer.remove(0, end + 4);
+            {
+                QMutexLocker lock(&mutex);
+                ++served;
+            }
+            if (path.startsWith("/hang/")) {
+                continue;
+            }
+            if (path.startsWith("/slow/")) {
+                QThread::msleep(200);
+            }
+            QByteArray body = "tile:" + path;
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: image/png\r\nContent-Length: " +
+                          QByteArray::number(body.size()) + "\r\n\r\n" + body);
+        }
+    }
+
+private:
+    QTcpServer *server;
+    QHash<QTcpSocket *, QByteArray> buffers;
+    QMutex mutex;
+    quint16 port;
+    int served;
+    int connections;
+};
+
+/**
+ * Fetches a list of tiles in its own thread, like the map loader threads do.
+ */
+class FetchThread : public QThread {
+public:
+    FetchThread(TileFetcher *Fetcher, quint16 Port, const QString &Path, const QList<int> &Tiles, int Timeout, bool Cancellable = true)
+        : fetcher(Fetcher), port(Port), path(Path), tiles(Tiles), timeout(Timeout), cancellable(Cancellable) {}
+
+    void run()
+    {
+        foreach(int x, tiles) {
+            QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/%2/%3").arg(port).arg(path).arg(x)));
+            TileFetcher::Result result;
+            QByteArray tile = fetcher->Fetch(RawTile(MapType::GoogleMap, Point(x, 0), ZOOM), request, timeout, &result, cancellable);
+
+            results.append(result);
+            data.append(tile);
+        }
+    }
+
+    QList<TileFetcher::Result> results;
+    QList<QByteArray> data;
+
+private:
+    TileFetcher *fetcher;
+    quint16 port;
+    QString path;
+    QList<int> tiles;
+    int timeout;
+    bool cancellable;
+};
+
+class tst_TileFetcher : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void fetchesTile();
+    void sharesConcurrentRequests();
+    void cancelWakesWaiters();
+    void keepsVisibleTiles();
+    void keepsNonCancellableTiles();
+    void timesOut();
+    void keepsConnectionsAlive();
+
+private:
+    QThread serverThread;
+    StubTileServer server;
+};
+
+void tst_TileFetcher::initTestCase()
+{
+    server.moveToThread(&serverThread);
+    serverThread.start();
+    QMetaObject::invokeMethod(&server, "listen", Qt::BlockingQueuedConnection);
+    QVERIFY(server.Port() != 0);
+}
+
+void tst_TileFetcher::cleanupTestCase()
+{
+    QMetaObject::invokeMethod(&server, "close", Qt::BlockingQueuedConnection);
+    serverThread.quit();
+    serverThread.wait();
+}
+
+void tst_TileFetcher::fetchesTile()
+{
+    TileFetcher fetcher;
+    FetchThread thread(&fetcher, server.Port(), "tile", QList<int>() << 1, 5000);
+
+    thread.start();
+    QVERIFY(thread.wait(5000));
+    QCOMPARE(thread.results.value(0), TileFetcher::Ok);
+    QCOMPARE(thread.data.value(0), QByteArray("tile:/tile/1"));
+}
+
+void tst_TileFetcher::sharesConcurrentRequests()
+{
+    TileFetcher fetcher;
+    QList<FetchThread *> threads;
+    int served = server.Served();
+
+    for (int i = 0; i < 4; ++i) {
+        threads.append(new FetchThread(&fetcher, server.Port(), "slow", QList<int>() << 2, 5000));
+        threads.last()->start();
+    }
+    foreach(FetchThread * thread, threads) {
+        QVERIFY(thread->wait(5000));
+        QCOMPARE(thread->results.value(0), TileFetcher::Ok);
+        QCOMPARE(thread->data.value(0), QByteArray("tile:/slow/2"));
+    }
+    qDeleteAll(threads);
+
+    // one download for all four callers
+    QCOMPARE(server.Served() - served, 1);
+    QCOMPARE(fetcher.SharedRequests(), 3);
+}
+
+void tst_TileFetcher::cancelWakesWaiters()
+{
+    TileFetcher fetcher;
+    FetchThread thread(&fetcher, server.Port(), "hang", QList<int>() << 3, 60000);
+    int served = server.Served();
+
+    thread.start();
+    QTRY_COMPARE(server.Served() - served, 1);
+
+    // the tile is never answered and the caller would wait a minute
+    fetcher.CancelTilesNotIn(ZOOM, QList<Point>() << Point(4, 0));
+    QVERIFY(thread.wait(30000));
+    QCOMPARE(thread.results.value(0), TileFetcher::Cancelled);
+    QCOMPARE(fetcher.CancelledRequests(), 1);
+    QTRY_COMPARE(fetcher.RequestsInFlight(), 0);
+}
+
+void tst_TileFetcher::keepsVisibleTiles()
+{
+    TileFetcher fetcher;
+    FetchThread thread(&fetcher, server.Port(), "slow", QList<int>() << 5, 5000);
+    int served = server.Served();
+
+    thread.start();
+    QTRY_COMPARE(server.Served() - served, 1);
+    fetcher.CancelTilesNotIn(ZOOM, QList<Point>() << Point(5, 0));
+    QVERIFY(thread.wait(5000));
+    QCOMPARE(thread.results.value(0), TileFetcher::Ok);
+    QCOMPARE(fetcher.CancelledRequests(), 0);
+}
+
+void tst_TileFetcher::keepsNonCancellableTiles()
+{
+    TileFetcher fetcher;
+    FetchThread thread(&fetcher, server.Port(), "slow", QList<int>() << 7, 5000, false);
+    int served = server.Served();
+
+    thread.start();
+    QTRY_COMPARE(server.Served() - served, 1);
+    // like the map ripper's downloads when the map view moves
+    fetcher.CancelAll();
+    QVERIFY(thread.wait(5000));
+    QCOMPARE(thread.results.value(0), TileFetcher::Ok);
+    QCOMPARE(thread.data.value(0), QByteArray("tile:/slow/7"));
+    QCOMPARE(fetcher.CancelledRequests(), 0);
+}
+
+void tst_TileFetcher::timesOut()
+{
+    TileFetcher fetcher;
+    FetchThread thread(&fetcher, server.Port(), "hang", QList<int>() << 6, 200);
+
+    thread.start();
+    QVERIFY(thread.wait(5000));
+    QCOMPARE(thread.results.value(0), TileFetcher::Timeout);
+    // the download nobody waits for anymore is aborted
+    QTRY_COMPARE(fetcher.RequestsInFlight(), 0);
+}
+
+void tst_TileFetcher::keepsConnectionsAlive()
+{
+    const int threadCount    = 8;
+    const int tilesPerThread = 100;
+
+    TileFetcher fetcher;
+    QList<FetchThread *> threads;
+    int connections = server.Connections();
+
+    for (int i = 0; i < threadCount; ++i) {
+        QList<int> tiles;
+        for (int j = 0; j < tilesPerThread; ++j) {
+            tiles.append(1000 + i * tilesPerThread + j);
+        }
+        threads.append(new FetchThread(&fetcher, server.Port(), "tile", tiles, 5000));
+        threads.last()->start();
+    }
+    foreach(FetchThread * thread, threads) {
+        QVERIFY(thread->wait(30000));
+        QCOMPARE(thread->results.count(TileFetcher::Ok), tilesPerThread);
+    }
+    qDeleteAll(threads);
+
+    // connections are kept alive instead of being opened per tile
+    QVERIFY(server.Connections() - connections <= 6);
+}
+
+QTEST_MAIN(tst_TileFetcher)
+
+#include "tst_tilefetcher.moc"
@@ -24,16 +24,32 @@
 
 #include "cachedsvgitem.h"
 #include <QDebug>
+#include <qmath.h>
 
 #ifndef GL_CLAMP_TO_EDGE
 #define GL_CLAMP_TO_EDGE 0x812F
 #endif
 
+// Larger pixmaps (e.g. a strongly zoomed view) are not worth caching
+#define MAX_PIXMAP_SIZE  2048
+// Memory the cached pixmaps of all items may take together, in bytes
+#define MAX_PIXMAP_BYTES (64 * 1024 * 1024)
+
+// Held by the cached pixmaps of all items, only used by the GUI thread
+static qint64 pixmapBytes = 0;
+
+static qint64 bytesOf(int width, int height)
+{
+    return (qint64)width * height * 4;
+}
+
 CachedSvgItem::CachedSvgItem(QGraphicsItem *parent) :
     QGraphicsSvgItem(parent),
     m_context(0),
     m_texture(0),
-    m_scale(1.0)
+    m_scale(1.0),
+    m_textureRenderer(0),
+    m_pixmapRenderer(0)
 {
     setCacheMode(NoCache);
 }
@@ -42,13 +58,16 @@ CachedSvgItem::CachedSvgItem(const QString & fileName, QGraphicsItem *parent) :
     QGraphicsSvgItem(fileName, parent),
     m_context(0),
     m_texture(0),
-    m_scale(1.0)
+    m_scale(1.0),
+    m_textureRenderer(0),
+    m_pixmapRenderer(0)
 {
     setCacheMode(NoCache);
 }
 
 CachedSvgItem::~CachedSvgItem()
 {
+    releasePixmap();
     if (m_context && m_texture) {
         m_context->makeCurrent();
         glDeleteTextures(1, &m_texture);
@@ -57,10 +76,13 @@ CachedSvgItem::~CachedSvgItem()
 
 void CachedSvgItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
+    Q_UNUSED(widget);
+
+    trackRenderer();
+
     if (painter->paintEngine()->type() != QPaintEngine::OpenGL &&
         painter->paintEngine()->type() != QPaintEngine::OpenGL2) {
-        // Fallback to direct painting
-        QGraphicsSvgItem::paint(painter, option, widget);
+        paintPixmap(painter, option);
         return;
     }
 
@@ -93,12 +115,17 @@ void CachedSvgItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
         dirty   = true;
     }
 
+    if (m_textureElement != elementId() || m_textureRenderer != renderer() || m_textureRect != br) {
+        m_textureElement  = elementId();
+        m_textureRenderer = renderer();
+        m_textureRect     = br;
+        dirty = true;
+    }
+
     int textureWidth  = (int(br.width() * m_scale) + 3) & ~3;
     int textureHeight = (int(br.height() * m_scale) + 3) & ~3;
 
     if (dirty) {
-        // qDebug() << "re-render image";
-
         QImage img(textureWidth, textureHeight, QImage::Format_ARGB32);
         {
             img.fill(Qt::transparent);
@@ -157,3 +184,89 @@ void CachedSvgItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
 
     painter->endNativePainting();
 }
+
+void CachedSvgItem::paintPixmap(QPainter *painter, const QStyleOptionGraphicsItem *option)
+{
+    QRectF br = boundingRect();
+    QTransform transform = painter->worldTransform();
+    QSizeF scale(transform.map(QLineF(0, 0, 1, 0)).length(),
+                 transform.map(QLineF(0, 0, 0, 1)).length());
+
+#if QT_VERSION >= 0x050100
+    scale *= painter->device()->devicePixelRatio();
+#endif
+
+    int pixmapWidth  = qCeil(br.width() * scale.width());
+    int pixmapHeight = qCeil(br.height() * scale.height());
+
+    // Scale is compared fuzzily, rotating the item must not trigger a re-render
+    if (m_pixmap.isNull() ||
+        !qFuzzyCompare(scale.width(), m_pixmapScale.width()) ||
+        !qFuzzyCompare(scale.height(), m_pixmapScale.height()) ||
+        m_pixmapElement != elementId() || m_pixmapRenderer != renderer() || m_pixmapRect != br) {
+        releasePixmap();
+        if (pixmapWidth <= 0 || pixmapHeight <= 0 ||
+            pixmapWidth > MAX_PIXMAP_SIZE || pixmapHeight > MAX_PIXMAP_SIZE ||
+            pixmapBytes + bytesOf(pixmapWidth, pixmapHeight) > MAX_PIXMAP_BYTES) {
+            // Fallback to direct painting
+            QGraphicsSvgItem::paint(painter, option, 0);
+            return;
+        }
+
+        QImage img(pixmapWidth, pixmapHeight, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::transparent);
+        QPainter p;
+        p.begin(&img);
+        p.setRenderHints(painter->renderHints());
+        p.scale(scale.width(), scale.height());
+        p.translate(-br.topLeft());
+        QGraphicsSvgItem::paint(&p, option, 0);
+        p.end();
+
+        m_pixmap         = QPixmap::fromImage(img);
+        m_pixmapScale    = scale;
+        m_pixmapElement  = elementId();
+        m_pixmapRenderer = renderer();
+        m_pixmapRect     = br;
+        pixmapBytes     += bytesOf(m_pixmap.width(), m_pixmap.height());
+    }
+
+    // Moving the item only changes the transform the pixmap is drawn with
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawPixmap(br, m_pixmap, QRectF(m_pixmap.rect()));
+    painter->restore();
+}
+
+/**
+ * Follow the renderer the item paints with, so that reloading it in place
+ * (QSvgRenderer::load()) invalidates the cached rendering
+ */
+void CachedSvgItem::trackRenderer()
+{
+    if (m_trackedRenderer == renderer()) {
+        return;
+    }
+    if (m_trackedRenderer) {
+        disconnect(m_trackedRenderer, SIGNAL(repaintNeeded()), this, SLOT(invalidateCache()));
+    }
+    m_trackedRenderer = renderer();
+    if (m_trackedRenderer) {
+        connect(m_trackedRenderer, SIGNAL(repaintNeeded()), this, SLOT(invalidateCache()));
+    }
+}
+
+void CachedSvgItem::invalidateCache()
+{
+    releasePixmap();
+    // a renderer that does not match re-renders the texture
+    m_textureRenderer = 0;
+}
+
+void CachedSvgItem::releasePixmap()
+{
+    if (!m_pixmap.isNull()) {
+        pixmapBytes -= bytesOf(m_pixmap.width(), m_pixmap.height());
+        m_pixmap     = QPixmap();
+    }
+}
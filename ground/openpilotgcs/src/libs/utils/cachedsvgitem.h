@@ -4,7 +4,7 @@
  * @file       cachedsvgitem.h
  * @author     Dmytro Poplavskiy Copyright (C) 2011.
  * @{
- * @brief OpenGL texture cached SVG item
+ * @brief OpenGL texture or pixmap cached SVG item
  *****************************************************************************/
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -26,6 +26,7 @@
 #define CACHEDSVGITEM_H
 
 #include <QGraphicsSvgItem>
+#include <QPointer>
 #include <QtOpenGL>
 #include <QtOpenGL/QGLContext>
 
@@ -33,9 +34,10 @@
 
 class QGLContext;
 
-// Cache Svg item as GL Texture.
-// Texture is regenerated each time item is scaled
-// but it's reused during rotation, unlike DeviceCoordinateCache mode
+// Cache Svg item as GL Texture, or as a pixmap when not painting with OpenGL.
+// Texture/pixmap is regenerated each time item is scaled, its element changes or
+// the renderer reloads, but it's reused during rotation and translation, unlike
+// DeviceCoordinateCache mode
 class QTCREATOR_UTILS_EXPORT CachedSvgItem : public QGraphicsSvgItem {
     Q_OBJECT
 public:
@@ -45,10 +47,28 @@ public:
 
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
 
+private slots:
+    void invalidateCache();
+
 private:
+    void paintPixmap(QPainter *painter, const QStyleOptionGraphicsItem *option);
+    void trackRenderer();
+    void releasePixmap();
+
+    QPointer<QSvgRenderer> m_trackedRenderer;
+
     QGLContext *m_context;
     GLuint m_texture;
     qreal m_scale;
+    QString m_textureElement;
+    QSvgRenderer *m_textureRenderer;
+    QRectF m_textureRect;
+
+    QPixmap m_pixmap;
+    QSizeF m_pixmapScale;
+    QString m_pixmapElement;
+    QSvgRenderer *m_pixmapRenderer;
+    QRectF m_pixmapRect;
 };
 
 #endif // ifndef CACHEDSVGITEM_H
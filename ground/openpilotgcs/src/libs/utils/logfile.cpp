@@ -1,15 +1,31 @@
 #include "logfile.h"
 #include <QDebug>
 #include <QtGlobal>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QtAlgorithms>
+
+// Magic number of the cached index file ("OPLI") and its format version
+#define LOGFILE_INDEX_MAGIC   0x4F504C49
+#define LOGFILE_INDEX_VERSION 1
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
-    m_lastTimeStamp(0),
+    m_dataBuffer(REPLAY_BUFFER_SIZE),
+    m_readyReadPending(0),
     m_lastPlayed(0),
     m_timeOffset(0),
     m_playbackSpeed(1.0),
     m_nextTimeStamp(0),
-    m_useProvidedTimeStamp(false)
+    m_useProvidedTimeStamp(false),
+    m_fileData(NULL),
+    m_nextRecord(0),
+    m_persistentIndex(false),
+    m_fastReplay(false)
 {
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(timerFired()));
 }
@@ -54,6 +70,12 @@ void LogFile::close()
     if (m_timer.isActive()) {
         m_timer.stop();
     }
+    if (m_fileData) {
+        m_file.unmap(m_fileData);
+        m_fileData = NULL;
+    }
+    m_index.clear();
+    m_nextRecord = 0;
     m_file.close();
     QIODevice::close();
 }
@@ -81,12 +103,10 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
 
 qint64 LogFile::readData(char *data, qint64 maxSize)
 {
-    QMutexLocker locker(&m_mutex);
-    qint64 toRead = qMin(maxSize, (qint64)m_dataBuffer.size());
+    // cleared before reading so that data queued from now on is notified again
+    m_readyReadPending.fetchAndStoreOrdered(0);
 
-    memcpy(data, m_dataBuffer.data(), toRead);
-    m_dataBuffer.remove(0, toRead);
-    return toRead;
+    return m_dataBuffer.read(data, (int)qMin(maxSize, (qint64)m_dataBuffer.capacity()));
 }
 
 qint64 LogFile::bytesAvailable() const
@@ -94,77 +114,228 @@ qint64 LogFile::bytesAvailable() const
     return m_dataBuffer.size();
 }
 
+/**
+ * Hand the records that are due over to the reader. The replay
+ * position advances with the playback speed, or by a batch of
+ * records per tick when replaying as fast as possible. Records
+ * that do not fit in the buffer wait for the reader to catch up.
+ */
 void LogFile::timerFired()
 {
-    qint64 dataSize;
-
-    if (m_file.bytesAvailable() > 4) {
-        int time;
-        time = m_myTime.elapsed();
-
-        // TODO: going back in time will be a problem
-        while ((m_lastPlayed + ((time - m_timeOffset) * m_playbackSpeed) > m_lastTimeStamp)) {
-            m_lastPlayed += ((time - m_timeOffset) * m_playbackSpeed);
-            if (m_file.bytesAvailable() < sizeof(dataSize)) {
-                stopReplay();
-                return;
-            }
-
-            m_file.read((char *)&dataSize, sizeof(dataSize));
-
-            if (dataSize < 1 || dataSize > (1024 * 1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
-            }
+    int records = 0;
 
-            if (m_file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
-            }
+    if (m_fastReplay) {
+        records = qMin(m_index.size() - m_nextRecord, FAST_REPLAY_BATCH);
+    } else {
+        int time = m_myTime.elapsed();
+        m_lastPlayed += (time - m_timeOffset) * m_playbackSpeed;
+        m_timeOffset  = time;
+        while (m_nextRecord + records < m_index.size() &&
+               m_index.at(m_nextRecord + records).timeStamp <= m_lastPlayed) {
+            records++;
+        }
+    }
 
-            m_mutex.lock();
-            m_dataBuffer.append(m_file.read(dataSize));
-            m_mutex.unlock();
+    int queued = 0;
+    while (queued < records && m_index.at(m_nextRecord).size <= m_dataBuffer.freeSpace()) {
+        const LogRecord &record = m_index.at(m_nextRecord++);
+        m_dataBuffer.write((const char *)m_fileData + record.offset, record.size);
+        queued++;
+    }
 
-            emit readyRead();
+    // one notification until the reader took data, also when records are stuck
+    // behind a full buffer
+    if (records > 0 && m_readyReadPending.testAndSetOrdered(0, 1)) {
+        emit readyRead();
+    }
 
-            if (m_file.bytesAvailable() < sizeof(m_lastTimeStamp)) {
-                stopReplay();
-                return;
-            }
+    if (queued > 0) {
+        if (m_fastReplay) {
+            m_lastPlayed = m_index.at(m_nextRecord - 1).timeStamp;
+        }
+        emit replayPositionChanged(replayPosition());
+    }
 
-            int save = m_lastTimeStamp;
-            m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
-            // some validity checks
-            if (m_lastTimeStamp < save // logfile goes back in time
-                || (m_lastTimeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
-                qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << m_lastTimeStamp << " after " << save << "\n";
-                stopReplay();
-                return;
-            }
+    // don't spin while a fast replay waits for the reader to make room
+    if (m_fastReplay) {
+        m_timer.setInterval(queued > 0 ? 0 : REPLAY_INTERVAL_MS);
+    }
 
-            m_timeOffset = time;
-            time = m_myTime.elapsed();
-        }
-    } else {
+    if (m_nextRecord >= m_index.size()) {
         stopReplay();
     }
 }
 
+/**
+ * Map the log file and index its records, then start replaying from the beginning.
+ */
 bool LogFile::startReplay()
 {
-    m_dataBuffer.clear();
+    m_dataBuffer.discardAll();
+    m_readyReadPending.store(0);
     m_myTime.restart();
     m_timeOffset = 0;
     m_lastPlayed = 0;
-    m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
-    m_timer.setInterval(10);
+    m_nextRecord = 0;
+
+    m_fileData   = m_file.map(0, m_file.size());
+    if (m_fileData == NULL) {
+        qDebug() << "Unable to map " << m_file.fileName() << " for replay";
+        m_index.clear();
+    } else if (!m_persistentIndex || !loadIndex()) {
+        buildIndex();
+        if (m_persistentIndex) {
+            saveIndex();
+        }
+    }
+
+    m_timer.setInterval(m_fastReplay ? 0 : REPLAY_INTERVAL_MS);
     m_timer.start();
     emit replayStarted();
     return true;
 }
 
+/**
+ * Scan the mapped log file for records. Replay stops at the first
+ * record that looks corrupted, as it did when reading the file sequentially.
+ */
+void LogFile::buildIndex()
+{
+    qint64 fileSize = m_file.size();
+    qint64 pos = 0;
+
+    m_index.clear();
+    while (pos + (qint64)(sizeof(quint32) + sizeof(qint64)) <= fileSize) {
+        LogRecord record;
+        memcpy(&record.timeStamp, m_fileData + pos, sizeof(quint32));
+        memcpy(&record.size, m_fileData + pos + sizeof(quint32), sizeof(qint64));
+        record.offset = pos + sizeof(quint32) + sizeof(qint64);
+
+        if (record.size < 1 || record.size > (1024 * 1024) || record.offset + record.size > fileSize) {
+            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << record.size << "\n";
+            break;
+        }
+        if (!m_index.isEmpty()) {
+            quint32 save = m_index.last().timeStamp;
+            if (record.timeStamp < save // logfile goes back in time
+                || (record.timeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes
+                qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << record.timeStamp << " after " << save << "\n";
+                break;
+            }
+        }
+
+        m_index.append(record);
+        pos = record.offset + record.size;
+    }
+}
+
+/**
+ * Index files are kept in the application cache directory, named after
+ * the absolute path of the log, so nothing is written next to the log.
+ */
+QString LogFile::indexFileName() const
+{
+    QString path = QFileInfo(m_file).absoluteFilePath();
+    QByteArray hash = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/logindex/" + QString(hash) + ".idx";
+}
+
+/**
+ * Load the cached index if it matches the log file.
+ */
+bool LogFile::loadIndex()
+{
+    QFile indexFile(indexFileName());
+
+    if (!indexFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&indexFile);
+    quint32 magic;
+    quint32 version;
+    qint64 fileSize;
+    qint64 lastModified;
+    qint32 count;
+    in >> magic >> version >> fileSize >> lastModified >> count;
+    if (in.status() != QDataStream::Ok || magic != LOGFILE_INDEX_MAGIC || version != LOGFILE_INDEX_VERSION ||
+        fileSize != m_file.size() || lastModified != QFileInfo(m_file).lastModified().toMSecsSinceEpoch() ||
+        count < 0 || count > indexFile.size() / 20) {
+        return false;
+    }
+
+    m_index.resize(count);
+    for (int i = 0; i < count; ++i) {
+        LogRecord &record = m_index[i];
+        in >> record.timeStamp >> record.offset >> record.size;
+        if (record.offset < 0 || record.size < 1 || record.offset + record.size > fileSize) {
+            m_index.clear();
+            return false;
+        }
+    }
+    if (in.status() != QDataStream::Ok) {
+        m_index.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Save the index to the cache directory, failing to do so is not an error.
+ */
+void LogFile::saveIndex()
+{
+    QFile indexFile(indexFileName());
+
+    QDir().mkpath(QFileInfo(indexFile).absolutePath());
+
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Unable to save the replay index " << indexFile.fileName();
+        return;
+    }
+
+    QDataStream out(&indexFile);
+    out << (quint32)LOGFILE_INDEX_MAGIC << (quint32)LOGFILE_INDEX_VERSION << m_file.size()
+        << QFileInfo(m_file).lastModified().toMSecsSinceEpoch() << (qint32)m_index.size();
+    foreach(const LogRecord &record, m_index) {
+        out << record.timeStamp << record.offset << record.size;
+    }
+}
+
+bool LogFile::recordBefore(const LogRecord &a, const LogRecord &b)
+{
+    return a.timeStamp < b.timeStamp;
+}
+
+/**
+ * Move the replay to the first record at or after position (in ms),
+ * works in both directions.
+ */
+void LogFile::setReplayPosition(int position)
+{
+    LogRecord key;
+
+    key.timeStamp = qMax(position, 0);
+    m_nextRecord  = qLowerBound(m_index.constBegin(), m_index.constEnd(), key, recordBefore) - m_index.constBegin();
+    m_lastPlayed  = key.timeStamp;
+    m_timeOffset  = m_myTime.elapsed();
+
+    m_dataBuffer.discardAll();
+
+    emit replayPositionChanged(replayPosition());
+}
+
+/**
+ * Replay the records as fast as possible instead of in real time.
+ */
+void LogFile::setFastReplay(bool fastReplay)
+{
+    m_fastReplay = fastReplay;
+    m_timeOffset = m_myTime.elapsed();
+    m_timer.setInterval(m_fastReplay ? 0 : REPLAY_INTERVAL_MS);
+}
+
 bool LogFile::stopReplay()
 {
     close();
@@ -8,7 +8,10 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QFile>
+#include <QVector>
 #include "utils_global.h"
+#include "ringbuffer.h"
+#include <QAtomicInt>
 
 class QTCREATOR_UTILS_EXPORT LogFile : public QIODevice {
     Q_OBJECT
@@ -40,12 +43,30 @@ public:
         m_nextTimeStamp = nextTimestamp;
     }
 
+    // Keep the replay index in the application cache directory so it is only built once
+    void setPersistentIndex(bool persistentIndex)
+    {
+        m_persistentIndex = persistentIndex;
+    }
+
+    // Replay position and length of the log in ms
+    int replayPosition() const
+    {
+        return (int)m_lastPlayed;
+    }
+    int replayDuration() const
+    {
+        return m_index.isEmpty() ? 0 : (int)m_index.last().timeStamp;
+    }
+
 public slots:
     void setReplaySpeed(double val)
     {
         m_playbackSpeed = val;
         qDebug() << "Playback speed is now" << m_playbackSpeed;
     };
+    void setReplayPosition(int position);
+    void setFastReplay(bool fastReplay);
     void pauseReplay();
     void resumeReplay();
 
@@ -56,23 +77,50 @@ signals:
     void readReady();
     void replayStarted();
     void replayFinished();
+    void replayPositionChanged(int position);
 
 protected:
-    QByteArray m_dataBuffer;
+    // Filled by the replay timer, emptied by the reader of the device
+    Utils::RingBuffer m_dataBuffer;
+    // Set while a readyRead() is pending, cleared by the reader
+    QAtomicInt m_readyReadPending;
     QTimer m_timer;
     QTime m_myTime;
     QFile m_file;
-    qint32 m_lastTimeStamp;
-    qint32 m_lastPlayed;
-    QMutex m_mutex;
+    double m_lastPlayed;
 
 
     int m_timeOffset;
     double m_playbackSpeed;
 
 private:
+    // Location of a record in the mapped log file
+    struct LogRecord {
+        quint32 timeStamp;
+        qint64  offset;
+        qint64  size;
+    };
+
+    static const int FAST_REPLAY_BATCH = 1000;
+    // Timer interval of the real time replay, and of a fast replay waiting for the reader
+    static const int REPLAY_INTERVAL_MS = 10;
+    // Larger than the largest record the index accepts
+    static const int REPLAY_BUFFER_SIZE = 2 * 1024 * 1024;
+
     quint32 m_nextTimeStamp;
     bool m_useProvidedTimeStamp;
+
+    uchar *m_fileData;
+    QVector<LogRecord> m_index;
+    int m_nextRecord;
+    bool m_persistentIndex;
+    bool m_fastReplay;
+
+    void buildIndex();
+    bool loadIndex();
+    void saveIndex();
+    QString indexFileName() const;
+    static bool recordBefore(const LogRecord &a, const LogRecord &b);
 };
 
 #endif // LOGFILE_H
@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringbuffer.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief Lock free single producer, single consumer byte ring buffer
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "ringbuffer.h"
+
+#include <string.h>
+
+using namespace Utils;
+
+RingBuffer::RingBuffer(int capacity) :
+    m_head(0),
+    m_tail(0),
+    m_discardTo(0),
+    m_discardPending(0)
+{
+    quint32 size = 1;
+
+    while (size < (quint32)qBound(1, capacity, 1 << 30)) {
+        size <<= 1;
+    }
+    m_mask   = size - 1;
+    m_buffer = new char[size];
+}
+
+RingBuffer::~RingBuffer()
+{
+    delete[] m_buffer;
+}
+
+int RingBuffer::size() const
+{
+    return (int)((quint32)m_head.loadAcquire() - (quint32)m_tail.loadAcquire());
+}
+
+int RingBuffer::freeSpace() const
+{
+    return capacity() - size();
+}
+
+int RingBuffer::write(const char *data, int size)
+{
+    quint32 head = (quint32)m_head.load();
+
+    size = qMin(size, freeSpace());
+    if (size <= 0) {
+        return 0;
+    }
+
+    quint32 offset = head & m_mask;
+    int first = qMin(size, (int)(m_mask + 1 - offset));
+    memcpy(m_buffer + offset, data, first);
+    memcpy(m_buffer, data + first, size - first);
+
+    // Publish the data only after it has been copied
+    m_head.storeRelease((int)(head + size));
+    return size;
+}
+
+void RingBuffer::discardAll()
+{
+    m_discardTo.storeRelease(m_head.load());
+    m_discardPending.storeRelease(1);
+}
+
+quint32 RingBuffer::readPosition()
+{
+    quint32 tail = (quint32)m_tail.load();
+
+    if (m_discardPending.testAndSetOrdered(1, 0)) {
+        quint32 discardTo = (quint32)m_discardTo.loadAcquire();
+        if ((qint32)(discardTo - tail) > 0) {
+            tail = discardTo;
+            m_tail.storeRelease((int)tail);
+        }
+    }
+    return tail;
+}
+
+void RingBuffer::copyOut(quint32 pos, char *data, int size) const
+{
+    quint32 offset = pos & m_mask;
+    int first = qMin(size, (int)(m_mask + 1 - offset));
+
+    memcpy(data, m_buffer + offset, first);
+    memcpy(data + first, m_buffer, size - first);
+}
+
+int RingBuffer::read(char *data, int size)
+{
+    quint32 tail = readPosition();
+
+    size = qMin(size, (int)((quint32)m_head.loadAcquire() - tail));
+    if (size <= 0) {
+        return 0;
+    }
+    copyOut(tail, data, size);
+
+    // Hand the space back only after the data has been copied
+    m_tail.storeRelease((int)(tail + size));
+    return size;
+}
+
+int RingBuffer::peek(char *data, int size)
+{
+    quint32 tail = readPosition();
+
+    size = qMin(size, (int)((quint32)m_head.loadAcquire() - tail));
+    if (size <= 0) {
+        return 0;
+    }
+    copyOut(tail, data, size);
+    return size;
+}
+
+int RingBuffer::skip(int size)
+{
+    quint32 tail = readPosition();
+
+    size = qMin(size, (int)((quint32)m_head.loadAcquire() - tail));
+    if (size <= 0) {
+        return 0;
+    }
+    m_tail.storeRelease((int)(tail + size));
+    return size;
+}
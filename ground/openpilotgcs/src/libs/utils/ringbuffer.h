@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringbuffer.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief Lock free single producer, single consumer byte ring buffer
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include "utils_global.h"
+
+#include <QAtomicInt>
+
+namespace Utils {
+/**
+ * Byte FIFO shared by exactly one producer and one consumer thread without
+ * locking. The capacity is rounded up to a power of two, the read and write
+ * positions are free running counters kept on separate cache lines so the
+ * two threads do not invalidate each other's cache on every access.
+ *
+ * write() and discardAll() may only be called by the producer, read(),
+ * peek() and skip() only by the consumer. size() and freeSpace() may be
+ * called by either. Discarded bytes are counted by both until the consumer
+ * skips them on its next access, so a read after discardAll() may return
+ * less than size() announced.
+ */
+class QTCREATOR_UTILS_EXPORT RingBuffer {
+public:
+    explicit RingBuffer(int capacity);
+    ~RingBuffer();
+
+    int capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    int size() const;
+    int freeSpace() const;
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Append up to \a size bytes, returns the number of bytes that fitted.
+     */
+    int write(const char *data, int size);
+
+    /**
+     * Drop everything written so far, the consumer skips it on its next read, peek or skip.
+     */
+    void discardAll();
+
+    /**
+     * Take up to \a size bytes out of the buffer, returns the number of bytes read.
+     */
+    int read(char *data, int size);
+
+    /**
+     * Copy up to \a size bytes without taking them out of the buffer.
+     */
+    int peek(char *data, int size);
+
+    /**
+     * Take up to \a size bytes out of the buffer without copying them.
+     */
+    int skip(int size);
+
+private:
+    Q_DISABLE_COPY(RingBuffer)
+
+    static const int CACHE_LINE_SIZE = 64;
+
+    quint32 readPosition();
+    void copyOut(quint32 pos, char *data, int size) const;
+
+    char *m_buffer;
+    quint32 m_mask;
+
+    char m_pad0[CACHE_LINE_SIZE];
+    // Written by the producer only
+    QAtomicInt m_head;
+    char m_pad1[CACHE_LINE_SIZE - sizeof(QAtomicInt)];
+    // Written by the consumer only
+    QAtomicInt m_tail;
+    char m_pad2[CACHE_LINE_SIZE - sizeof(QAtomicInt)];
+    // Handed from the producer to the consumer by discardAll()
+    QAtomicInt m_discardTo;
+    QAtomicInt m_discardPending;
+};
+} // namespace Utils
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,13 @@
+QT -= gui
+QT += testlib
+TARGET = tst_crc
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../openpilotgcs.pri)
+include(../../utils.pri)
+
+LIBS += -L$$GCS_LIBRARY_PATH
+
+SOURCES += tst_crc.cpp
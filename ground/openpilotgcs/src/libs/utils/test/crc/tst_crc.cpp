@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_crc.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Equivalence tests and throughput benchmark for Utils::Crc
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <utils/crc.h>
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+using namespace Utils;
+
+class tst_Crc : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void knownValue();
+    void bufferMatchesBytewise();
+
+    void throughputBytewise();
+    void throughputBuffer();
+
+private:
+    QByteArray data;
+
+    static quint8 bytewiseCRC(quint8 crc, const quint8 *data, qint32 length);
+};
+
+void tst_Crc::initTestCase()
+{
+    qsrand(0x3C);
+    data.resize(64 * 1024);
+    for (int i = 0; i < data.size(); ++i) {
+        data[i] = (char)(qrand() & 0xFF);
+    }
+}
+
+/**
+ * Reference implementation, one table lookup per byte.
+ */
+quint8 tst_Crc::bytewiseCRC(quint8 crc, const quint8 *data, qint32 length)
+{
+    for (qint32 i = 0; i < length; ++i) {
+        crc = Crc::updateCRC(crc, data[i]);
+    }
+    return crc;
+}
+
+void tst_Crc::knownValue()
+{
+    // CRC-8 (poly 0x07, init 0x00) check value
+    QCOMPARE(Crc::updateCRC(0, (const quint8 *)"123456789", 9), (quint8)0xF4);
+}
+
+void tst_Crc::bufferMatchesBytewise()
+{
+    const quint8 *buffer = (const quint8 *)data.constData();
+
+    // Every initial crc value, every length up to a few blocks and every alignment
+    for (int crc = 0; crc < 256; ++crc) {
+        for (int offset = 0; offset < 8; ++offset) {
+            for (int length = 0; length <= 300; ++length) {
+                if (Crc::updateCRC(crc, buffer + offset, length) != bytewiseCRC(crc, buffer + offset, length)) {
+                    QFAIL(qPrintable(QString("mismatch for crc %1, offset %2, length %3").arg(crc).arg(offset).arg(length)));
+                }
+            }
+        }
+    }
+    QCOMPARE(Crc::updateCRC(0, buffer, data.size()), bytewiseCRC(0, buffer, data.size()));
+}
+
+void tst_Crc::throughputBytewise()
+{
+    quint8 crc = 0;
+
+    QBENCHMARK {
+        crc = bytewiseCRC(crc, (const quint8 *)data.constData(), data.size());
+    }
+    Q_UNUSED(crc);
+}
+
+void tst_Crc::throughputBuffer()
+{
+    quint8 crc = 0;
+
+    QBENCHMARK {
+        crc = Crc::updateCRC(crc, (const quint8 *)data.constData(), data.size());
+    }
+    Q_UNUSED(crc);
+}
+
+QTEST_MAIN(tst_Crc)
+
+#include "tst_crc.moc"
@@ -0,0 +1,189 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_ringbuffer.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Tests and throughput benchmark for Utils::RingBuffer
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <utils/ringbuffer.h>
+
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QtTest>
+
+using namespace Utils;
+
+static const int STREAM_SIZE = 16 * 1024 * 1024;
+
+/**
+ * Writes a counting byte pattern in odd sized chunks, like a HID read thread.
+ */
+class ProducerThread : public QThread {
+public:
+    ProducerThread(RingBuffer *ring) : ring(ring)
+    {}
+
+    void run()
+    {
+        char chunk[62];
+        int written = 0;
+
+        while (written < STREAM_SIZE) {
+            int size = qMin((int)sizeof(chunk), STREAM_SIZE - written);
+            for (int i = 0; i < size; ++i) {
+                chunk[i] = (char)(written + i);
+            }
+            int pos = 0;
+            while (pos < size) {
+                int n = ring->write(chunk + pos, size - pos);
+                if (n == 0) {
+                    QThread::yieldCurrentThread();
+                }
+                pos += n;
+            }
+            written += size;
+        }
+    }
+
+private:
+    RingBuffer *ring;
+};
+
+class tst_RingBuffer : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roundsCapacity();
+    void wrapsAround();
+    void stopsWhenFull();
+    void peeksAndSkips();
+    void discardsAll();
+
+    void concurrentTransfer();
+};
+
+void tst_RingBuffer::roundsCapacity()
+{
+    QCOMPARE(RingBuffer(1).capacity(), 1);
+    QCOMPARE(RingBuffer(64).capacity(), 64);
+    QCOMPARE(RingBuffer(65).capacity(), 128);
+    QCOMPARE(RingBuffer(1000).capacity(), 1024);
+}
+
+void tst_RingBuffer::wrapsAround()
+{
+    RingBuffer ring(16);
+    char out[16];
+
+    // Move the positions close to the end of the storage so the next write wraps
+    QCOMPARE(ring.write("0123456789ab", 12), 12);
+    QCOMPARE(ring.read(out, 12), 12);
+
+    QCOMPARE(ring.write("ABCDEFGHIJ", 10), 10);
+    QCOMPARE(ring.size(), 10);
+    QCOMPARE(ring.read(out, 16), 10);
+    QCOMPARE(QByteArray(out, 10), QByteArray("ABCDEFGHIJ"));
+    QVERIFY(ring.isEmpty());
+}
+
+void tst_RingBuffer::stopsWhenFull()
+{
+    RingBuffer ring(8);
+    char out[8];
+
+    QCOMPARE(ring.write("0123456789", 10), 8);
+    QCOMPARE(ring.freeSpace(), 0);
+    QCOMPARE(ring.write("x", 1), 0);
+    QCOMPARE(ring.read(out, 3), 3);
+    QCOMPARE(ring.freeSpace(), 3);
+    QCOMPARE(ring.write("abcd", 4), 3);
+    QCOMPARE(ring.read(out, 8), 8);
+    QCOMPARE(QByteArray(out, 8), QByteArray("34567abc"));
+}
+
+void tst_RingBuffer::peeksAndSkips()
+{
+    RingBuffer ring(16);
+    char out[16];
+
+    ring.write("hello world", 11);
+    QCOMPARE(ring.peek(out, 5), 5);
+    QCOMPARE(QByteArray(out, 5), QByteArray("hello"));
+    QCOMPARE(ring.size(), 11);
+    QCOMPARE(ring.skip(6), 6);
+    QCOMPARE(ring.read(out, 16), 5);
+    QCOMPARE(QByteArray(out, 5), QByteArray("world"));
+    QCOMPARE(ring.skip(1), 0);
+}
+
+void tst_RingBuffer::discardsAll()
+{
+    RingBuffer ring(16);
+    char out[16];
+
+    ring.write("old", 3);
+    ring.discardAll();
+    ring.write("new", 3);
+
+    // The discarded bytes are only skipped, and their space handed back, by the next read
+    QCOMPARE(ring.size(), 6);
+    QCOMPARE(ring.read(out, 16), 3);
+    QCOMPARE(QByteArray(out, 3), QByteArray("new"));
+    QVERIFY(ring.isEmpty());
+    QCOMPARE(ring.freeSpace(), 16);
+}
+
+void tst_RingBuffer::concurrentTransfer()
+{
+    RingBuffer ring(4096);
+    ProducerThread producer(&ring);
+    char out[1000];
+    int received = 0;
+    bool intact  = true;
+
+    QElapsedTimer timer;
+    timer.start();
+    producer.start();
+    while (received < STREAM_SIZE && timer.elapsed() < 30000) {
+        int n = ring.read(out, sizeof(out));
+        if (n == 0) {
+            QThread::yieldCurrentThread();
+        }
+        for (int i = 0; i < n; ++i) {
+            intact &= (out[i] == (char)(received + i));
+        }
+        received += n;
+    }
+    QVERIFY(producer.wait(5000));
+    QCOMPARE(received, STREAM_SIZE);
+    QVERIFY(intact);
+    QVERIFY(ring.isEmpty());
+
+    qint64 elapsed = qMax(timer.elapsed(), (qint64)1);
+    qDebug() << "Transferred" << STREAM_SIZE / (1024 * 1024) << "MB in" << elapsed << "ms";
+}
+
+QTEST_MAIN(tst_RingBuffer)
+
+#include "tst_ringbuffer.moc"
@@ -49,6 +49,8 @@ GeneralSettings::GeneralSettings() :
     m_autoSelect(true),
     m_useUDPMirror(false),
     m_useExpertMode(false),
+    m_useThreadedTelemetry(false),
+    m_telemetryRetrievalWindow(8),
     m_dialog(0)
 {}
 
@@ -125,6 +127,8 @@ QWidget *GeneralSettings::createPage(QWidget *parent)
     m_page->checkAutoSelect->setChecked(m_autoSelect);
     m_page->cbUseUDPMirror->setChecked(m_useUDPMirror);
     m_page->cbExpertMode->setChecked(m_useExpertMode);
+    m_page->cbThreadedTelemetry->setChecked(m_useThreadedTelemetry);
+    m_page->sbRetrievalWindow->setValue(m_telemetryRetrievalWindow);
     m_page->colorButton->setColor(StyleHelper::baseColor());
 
     connect(m_page->resetButton, SIGNAL(clicked()), this, SLOT(resetInterfaceColor()));
@@ -143,6 +147,8 @@ void GeneralSettings::apply()
     m_saveSettingsOnExit = m_page->checkBoxSaveOnExit->isChecked();
     m_useUDPMirror  = m_page->cbUseUDPMirror->isChecked();
     m_useExpertMode = m_page->cbExpertMode->isChecked();
+    m_useThreadedTelemetry = m_page->cbThreadedTelemetry->isChecked();
+    m_telemetryRetrievalWindow = m_page->sbRetrievalWindow->value();
     m_autoConnect   = m_page->checkAutoConnect->isChecked();
     m_autoSelect    = m_page->checkAutoSelect->isChecked();
 }
@@ -161,6 +167,8 @@ void GeneralSettings::readSettings(QSettings *qs)
     m_autoSelect    = qs->value(QLatin1String("AutoSelect"), m_autoSelect).toBool();
     m_useUDPMirror  = qs->value(QLatin1String("UDPMirror"), m_useUDPMirror).toBool();
     m_useExpertMode = qs->value(QLatin1String("ExpertMode"), m_useExpertMode).toBool();
+    m_useThreadedTelemetry = qs->value(QLatin1String("ThreadedTelemetry"), m_useThreadedTelemetry).toBool();
+    m_telemetryRetrievalWindow = qs->value(QLatin1String("TelemetryRetrievalWindow"), m_telemetryRetrievalWindow).toInt();
     qs->endGroup();
 }
 
@@ -179,6 +187,8 @@ void GeneralSettings::saveSettings(QSettings *qs)
     qs->setValue(QLatin1String("AutoSelect"), m_autoSelect);
     qs->setValue(QLatin1String("UDPMirror"), m_useUDPMirror);
     qs->setValue(QLatin1String("ExpertMode"), m_useExpertMode);
+    qs->setValue(QLatin1String("ThreadedTelemetry"), m_useThreadedTelemetry);
+    qs->setValue(QLatin1String("TelemetryRetrievalWindow"), m_telemetryRetrievalWindow);
     qs->endGroup();
 }
 
@@ -254,6 +264,16 @@ bool GeneralSettings::useExpertMode() const
     return m_useExpertMode;
 }
 
+bool GeneralSettings::useThreadedTelemetry() const
+{
+    return m_useThreadedTelemetry;
+}
+
+int GeneralSettings::telemetryRetrievalWindow() const
+{
+    return m_telemetryRetrievalWindow;
+}
+
 void GeneralSettings::slotAutoConnect(int value)
 {
     if (value == Qt::Checked) {
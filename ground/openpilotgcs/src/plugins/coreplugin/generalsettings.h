@@ -60,6 +60,8 @@ public:
     void readSettings(QSettings *qs);
     void saveSettings(QSettings *qs);
     bool useExpertMode() const;
+    bool useThreadedTelemetry() const;
+    int telemetryRetrievalWindow() const;
 signals:
 
 private slots:
@@ -79,6 +81,8 @@ private:
     bool m_autoSelect;
     bool m_useUDPMirror;
     bool m_useExpertMode;
+    bool m_useThreadedTelemetry;
+    int m_telemetryRetrievalWindow;
     QPointer<QWidget> m_dialog;
     QList<QTextCodec *> m_codecs;
 };
@@ -251,14 +251,14 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
     setBackgroundBrush(QBrush(Utils::StyleHelper::baseColor()));
     if (QFile::exists(dfn) && m_renderer->load(dfn) && m_renderer->isValid()) {
         l_scene->clear(); // This also deletes all items contained in the scene.
-        m_background = new QGraphicsSvgItem();
+        m_background = new CachedSvgItem();
         // All other items will be clipped to the shape of the background
         m_background->setFlags(QGraphicsItem::ItemClipsChildrenToShape |
                                QGraphicsItem::ItemClipsToShape);
-        m_foreground = new QGraphicsSvgItem();
-        m_needle1    = new QGraphicsSvgItem();
-        m_needle2    = new QGraphicsSvgItem();
-        m_needle3    = new QGraphicsSvgItem();
+        m_foreground = new CachedSvgItem();
+        m_needle1    = new CachedSvgItem();
+        m_needle2    = new CachedSvgItem();
+        m_needle3    = new CachedSvgItem();
         m_needle1->setParentItem(m_background);
         m_needle2->setParentItem(m_background);
         m_needle3->setParentItem(m_background);
@@ -428,7 +428,7 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
         qDebug() << "no file: display default background.";
         m_renderer->load(QString(":/dial/images/empty.svg"));
         l_scene->clear(); // This also deletes all items contained in the scene.
-        m_background = new QGraphicsSvgItem();
+        m_background = new CachedSvgItem();
         m_background->setSharedRenderer(m_renderer);
         l_scene->addItem(m_background);
         m_text1   = NULL;
@@ -36,6 +36,7 @@
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
+#include <utils/cachedsvgitem.h>
 
 #include <QFile>
 #include <QTimer>
@@ -116,11 +117,11 @@ private slots:
 
 private:
     QSvgRenderer *m_renderer;
-    QGraphicsSvgItem *m_background;
-    QGraphicsSvgItem *m_foreground;
-    QGraphicsSvgItem *m_needle1;
-    QGraphicsSvgItem *m_needle2;
-    QGraphicsSvgItem *m_needle3;
+    CachedSvgItem *m_background;
+    CachedSvgItem *m_foreground;
+    CachedSvgItem *m_needle1;
+    CachedSvgItem *m_needle2;
+    CachedSvgItem *m_needle3;
     QGraphicsTextItem *m_text1;
     QGraphicsTextItem *m_text2;
     QGraphicsTextItem *m_text3;
@@ -76,6 +76,7 @@ Rectangle {
                                     case 0 : text: qsTr("Empty"); break;
                                     case 1 : text: qsTr("Text"); break;
                                     case 2 : text: qsTr("UAVO"); break;
+                                    case 3 : text: qsTr("UAVOs"); break;
                                     default: text: qsTr("Unknown"); break;
                                     }
                                 }
@@ -101,6 +102,11 @@ Rectangle {
                             text: "<b>" + qsTr("Entries logged (free): ") + "</b>" +
                                   logStatus.UsedSlots + " (" + logStatus.FreeSlots + ")"
                         }
+                        Text {
+                            id: downloadRate
+                            font.pixelSize: 12
+                            text: "<b>" + qsTr("Download rate: ") + "</b>" + logManager.throughput
+                        }
                     }
                     Rectangle {
                         Layout.fillWidth: true
@@ -30,6 +30,8 @@
 
 #include <QApplication>
 #include <QFileDialog>
+#include <QTime>
+#include <QtEndian>
 
 #include "debuglogcontrol.h"
 #include "uavobjecthelper.h"
@@ -39,7 +41,9 @@
 FlightLogManager::FlightLogManager(QObject *parent) :
     QObject(parent), m_disableControls(false),
     m_disableExport(true), m_cancelDownload(false),
-    m_adjustExportedTimestamps(true)
+    m_adjustExportedTimestamps(true),
+    m_streamFlight(-1), m_streamEnd(-1), m_streamWindowFirst(0),
+    m_streamWindowEnd(0)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
 
@@ -55,6 +59,10 @@ FlightLogManager::FlightLogManager(QObject *parent) :
 
     m_flightLogEntry = DebugLogEntry::GetInstance(m_objectManager);
     Q_ASSERT(m_flightLogEntry);
+    connect(m_flightLogEntry, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(logEntryUnpacked(UAVObject *)), Qt::DirectConnection);
+
+    m_streamTimer.setSingleShot(true);
+    connect(&m_streamTimer, SIGNAL(timeout()), &m_streamLoop, SLOT(quit()));
 
     updateFlightEntries(m_flightLogStatus->getFlight());
 }
@@ -135,8 +143,6 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     setDisableControls(true);
     QApplication::setOverrideCursor(Qt::WaitCursor);
     m_cancelDownload = false;
-    UAVObjectUpdaterHelper updateHelper;
-    UAVObjectRequestHelper requestHelper;
 
     clearLogList();
 
@@ -144,42 +150,15 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
     int endFlight   = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
 
-    // Prepare to send request for event retrieval
-    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
+    QTime downloadTime;
+    downloadTime.start();
     for (int flight = startFlight; flight <= endFlight; flight++) {
-        m_flightLogControl->setFlight(flight);
-        bool gotLast = false;
-        int entry    = 0;
-        while (!gotLast) {
-            // Send request for loading flight entry on flight side and wait for ack/nack
-            m_flightLogControl->setEntry(entry);
-
-            if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
-                requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
-                if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-
-                    // Increment to get next entry from flight side
-                    entry++;
-                } else {
-                    // We are done, not more entries on this flight
-                    gotLast = true;
-                }
-            } else {
-                // We failed for some reason
-                break;
-            }
-            if (m_cancelDownload) {
-                break;
-            }
-        }
+        retrieveFlightStreamed(flight);
         if (m_cancelDownload) {
             break;
         }
     }
+    updateThroughput(m_logEntries.count(), downloadTime.elapsed());
 
     if (m_cancelDownload) {
         clearLogList();
@@ -193,6 +172,194 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     setDisableControls(false);
 }
 
+FlightLogManager::EntryResult FlightLogManager::retrieveEntry(int flight, int entry, DebugLogEntry::DataFields &data)
+{
+    UAVObjectUpdaterHelper updateHelper;
+    UAVObjectRequestHelper requestHelper;
+
+    // Send request for loading flight entry on flight side and wait for ack/nack
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
+    m_flightLogControl->setFlight(flight);
+    m_flightLogControl->setEntry(entry);
+
+    if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) != UAVObjectUpdaterHelper::SUCCESS ||
+        requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) != UAVObjectUpdaterHelper::SUCCESS) {
+        // We failed for some reason
+        return ENTRY_FAILED;
+    }
+
+    data = m_flightLogEntry->getData();
+    return (data.Type != DebugLogEntry::TYPE_EMPTY) ? ENTRY_OK : ENTRY_EMPTY;
+}
+
+void FlightLogManager::retrieveFlightStreamed(int flight)
+{
+    UAVObjectUpdaterHelper updateHelper;
+    int stalls = 0;
+    int next   = 0;
+
+    takeStreamedEntries();
+    m_streamedEntries.clear();
+    m_streamFlight = flight;
+    m_streamEnd    = -1;
+
+    QTime windowTime;
+    while (!m_cancelDownload && (m_streamEnd < 0 || next < m_streamEnd) && stalls < STREAM_MAX_STALLS) {
+        // Ask for the gap starting at the first missing entry, or for a
+        // full window past the last one received
+        int count = 1;
+        while (count < STREAM_WINDOW && !m_streamedEntries.contains(next + count) &&
+               (m_streamEnd < 0 || next + count < m_streamEnd)) {
+            count++;
+        }
+        m_streamWindowFirst = next;
+        m_streamWindowEnd   = next + count;
+
+        int received = m_streamedEntries.count();
+        int end = m_streamEnd;
+        windowTime.start();
+
+        m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVERANGE);
+        m_flightLogControl->setFlight(flight);
+        m_flightLogControl->setEntry(next);
+        m_flightLogControl->setCount(count);
+        if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) != UAVObjectUpdaterHelper::SUCCESS) {
+            break;
+        }
+        takeStreamedEntries();
+        if (!streamWindowComplete()) {
+            m_streamTimer.start(STREAM_IDLE_TIMEOUT);
+            m_streamLoop.exec();
+            m_streamTimer.stop();
+        }
+        takeStreamedEntries();
+
+        if (m_streamedEntries.count() == received && m_streamEnd == end) {
+            stalls++;
+        } else {
+            stalls = 0;
+            updateThroughput(m_streamedEntries.count() - received, windowTime.elapsed());
+        }
+        while (m_streamedEntries.contains(next)) {
+            next++;
+        }
+    }
+    m_streamFlight = -1;
+
+    // Add the entries in order, fetching what the stream lost one at a time
+    for (int entry = 0; !m_cancelDownload && (m_streamEnd < 0 || entry < m_streamEnd); entry++) {
+        if (!m_streamedEntries.contains(entry)) {
+            DebugLogEntry::DataFields data;
+            EntryResult result = retrieveEntry(flight, entry, data);
+            if (result != ENTRY_OK) {
+                if (result == ENTRY_FAILED) {
+                    qWarning() << "FlightLogManager: could not retrieve entry" << entry << "of flight" << flight;
+                }
+                break;
+            }
+            m_streamedEntries.insert(entry, data);
+        }
+        addLogEntry(m_streamedEntries.value(entry));
+    }
+    m_streamedEntries.clear();
+}
+
+bool FlightLogManager::streamWindowComplete() const
+{
+    for (int entry = m_streamWindowFirst; entry < m_streamWindowEnd; entry++) {
+        if (m_streamEnd >= 0 && entry >= m_streamEnd) {
+            break;
+        }
+        if (!m_streamedEntries.contains(entry)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Copy each DebugLogEntry update while it is unpacked, called in the thread
+ * that unpacks it.
+ */
+void FlightLogManager::logEntryUnpacked(UAVObject *object)
+{
+    Q_UNUSED(object);
+
+    // the object is still locked by the unpack, this is the data of this update
+    DebugLogEntry::DataFields data = m_flightLogEntry->getData();
+
+    QMutexLocker locker(&m_streamQueueMutex);
+    if (m_streamQueue.isEmpty()) {
+        QMetaObject::invokeMethod(this, "streamedEntriesQueued", Qt::QueuedConnection);
+    }
+    m_streamQueue.append(data);
+}
+
+void FlightLogManager::streamedEntriesQueued()
+{
+    if (!takeStreamedEntries()) {
+        return;
+    }
+    if (streamWindowComplete()) {
+        m_streamLoop.quit();
+    } else {
+        m_streamTimer.start(STREAM_IDLE_TIMEOUT);
+    }
+}
+
+/**
+ * Add the entries copied so far to the stream, and drop those that are not
+ * part of it.
+ * @return true if the stream received entries
+ */
+bool FlightLogManager::takeStreamedEntries()
+{
+    QList<DebugLogEntry::DataFields> entries;
+    {
+        QMutexLocker locker(&m_streamQueueMutex);
+        entries.swap(m_streamQueue);
+    }
+
+    bool received = false;
+    foreach(const DebugLogEntry::DataFields &data, entries) {
+        if (m_streamFlight < 0 || data.Flight != m_streamFlight) {
+            continue;
+        }
+        if (data.Type == DebugLogEntry::TYPE_EMPTY) {
+            if (m_streamEnd < 0 || data.Entry < m_streamEnd) {
+                m_streamEnd = data.Entry;
+            }
+        } else {
+            m_streamedEntries.insert(data.Entry, data);
+        }
+        received = true;
+    }
+    return received;
+}
+
+void FlightLogManager::addLogEntry(const DebugLogEntry::DataFields &data)
+{
+    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+
+    logEntry->setData(data, m_objectManager);
+    m_logEntries << logEntry;
+}
+
+void FlightLogManager::updateThroughput(int entries, int elapsedMs)
+{
+    if (elapsedMs <= 0) {
+        return;
+    }
+    double entriesPerSecond = entries * 1000.0 / elapsedMs;
+    QString throughput = tr("%1 entries/s (%2 kB/s)")
+                         .arg(entriesPerSecond, 0, 'f', 1)
+                         .arg(entriesPerSecond * m_flightLogEntry->getNumBytes() / 1024.0, 0, 'f', 1);
+    if (m_throughput != throughput) {
+        m_throughput = throughput;
+        emit throughputChanged(throughput);
+    }
+}
+
 void FlightLogManager::exportLogs()
 {
     if (m_logEntries.isEmpty()) {
@@ -232,14 +399,14 @@ void FlightLogManager::exportLogs()
             while (currentEntry < m_logEntries.count() && m_logEntries[currentEntry]->getFlight() == currentFlight) {
                 ExtendedDebugLogEntry *entry = m_logEntries[currentEntry];
 
-                // Only log uavobjects
-                if (entry->getType() == ExtendedDebugLogEntry::TYPE_UAVOBJECT) {
-                    // Set timestamp that should be logged for this entry
-                    logFile.setNextTimeStamp(entry->getFlightTime() - adjustedBaseTime);
+                // Only log uavobjects, text entries carry none
+                for (int i = 0; i < entry->objectCount(); i++) {
+                    // Set timestamp that should be logged for this object
+                    logFile.setNextTimeStamp(entry->objectTime(i) - adjustedBaseTime);
 
                     // Use UAVTalk to log complete message to file
-                    uavTalk.sendObject(entry->uavObject(), false, false);
-                    qDebug() << entry->getFlightTime() - adjustedBaseTime << "=" << entry->toStringBrief();
+                    uavTalk.sendObject(entry->uavObject(i), false, false);
+                    qDebug() << entry->objectTime(i) - adjustedBaseTime << "=" << entry->uavObject(i)->toStringBrief();
                 }
                 currentEntry++;
             }
@@ -274,24 +441,27 @@ void FlightLogManager::updateFlightEntries(quint16 currentFlight)
     }
 }
 
-ExtendedDebugLogEntry::ExtendedDebugLogEntry() : DebugLogEntry(),
-    m_object(0)
+ExtendedDebugLogEntry::ExtendedDebugLogEntry() : DebugLogEntry()
 {}
 
 ExtendedDebugLogEntry::~ExtendedDebugLogEntry()
 {
-    if (m_object) {
-        delete m_object;
-        m_object = 0;
-    }
+    qDeleteAll(m_objects);
+    m_objects.clear();
 }
 
 QString ExtendedDebugLogEntry::getLogString()
 {
     if (getType() == DebugLogEntry::TYPE_TEXT) {
         return QString((const char *)getData().Data);
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT) {
-        return m_object->toString().replace("\n", " ").replace("\t", " ");
+    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT && !m_objects.isEmpty()) {
+        return m_objects.first()->toString().replace("\n", " ").replace("\t", " ");
+    } else if (getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        QStringList objects;
+        foreach(UAVDataObject * object, m_objects) {
+            objects << object->toStringBrief();
+        }
+        return objects.join("; ");
     } else {
         return "";
     }
@@ -302,9 +472,53 @@ void ExtendedDebugLogEntry::setData(const DebugLogEntry::DataFields &data, UAVOb
     DebugLogEntry::setData(data);
 
     if (getType() == DebugLogEntry::TYPE_UAVOBJECT) {
-        UAVDataObject *object = (UAVDataObject *)objectManager->getObject(getObjectID(), getInstanceID());
-        Q_ASSERT(object);
-        m_object = object->clone(getInstanceID());
-        m_object->unpack(getData().Data);
+        UAVDataObject *object = createObject(getObjectID(), getInstanceID(), data.Data, sizeof(data.Data), objectManager);
+        if (object) {
+            m_objects << object;
+            m_objectTimes << getFlightTime();
+        }
+    } else if (getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        // Records are packed back to back, see debuglogentry.xml
+        int size = qMin((int)data.Size, (int)sizeof(data.Data));
+        int pos  = 0;
+        while (pos + PACKED_HEADER_SIZE <= size) {
+            const quint8 *record = &data.Data[pos];
+            quint32 objectId   = qFromLittleEndian<quint32>(record);
+            quint16 instanceId = qFromLittleEndian<quint16>(record + 4);
+            quint16 offset     = qFromLittleEndian<quint16>(record + 6);
+            quint16 dataSize   = qFromLittleEndian<quint16>(record + 8);
+            if (pos + PACKED_HEADER_SIZE + dataSize > size) {
+                qWarning() << "ExtendedDebugLogEntry: truncated record in entry" << getEntry() << "of flight" << getFlight();
+                break;
+            }
+            UAVDataObject *object = createObject(objectId, instanceId, record + PACKED_HEADER_SIZE, dataSize, objectManager);
+            if (object) {
+                m_objects << object;
+                m_objectTimes << getFlightTime() + offset;
+            }
+            pos += PACKED_HEADER_SIZE + dataSize;
+        }
+    }
+}
+
+UAVDataObject *ExtendedDebugLogEntry::createObject(quint32 objectId, quint32 instanceId, const quint8 *data, int size, UAVObjectManager *objectManager)
+{
+    // The instance may not exist on the GCS side, clone it from the first one
+    UAVDataObject *object = (UAVDataObject *)objectManager->getObject(objectId, instanceId);
+
+    if (!object) {
+        object = (UAVDataObject *)objectManager->getObject(objectId);
+    }
+    if (!object) {
+        qWarning() << "ExtendedDebugLogEntry: unknown object" << objectId << "in entry" << getEntry() << "of flight" << getFlight();
+        return 0;
     }
+    object = object->clone(instanceId);
+
+    // Objects larger than a log entry are dropped on the flight side, so a size
+    // mismatch means a different object definition: keep the part that fits
+    QByteArray buffer(object->getNumBytes(), 0);
+    memcpy(buffer.data(), data, qMin(size, buffer.size()));
+    object->unpack((const quint8 *)buffer.constData());
+    return object;
 }
@@ -32,6 +32,10 @@
 #include <QList>
 #include <QQmlListProperty>
 #include <QSemaphore>
+#include <QEventLoop>
+#include <QTimer>
+#include <QMap>
+#include <QMutex>
 
 #include "uavobjectmanager.h"
 #include "debuglogentry.h"
@@ -46,9 +50,21 @@ public:
     ~ExtendedDebugLogEntry();
 
     QString getLogString();
-    UAVDataObject *uavObject()
+
+    // Object updates carried by this entry, one for TYPE_UAVOBJECT and
+    // one per packed record for TYPE_MULTIPLEUAVOBJECTS
+    int objectCount() const
+    {
+        return m_objects.count();
+    }
+    UAVDataObject *uavObject(int index = 0)
     {
-        return m_object;
+        return m_objects.value(index, 0);
+    }
+    // Flight time in ms of object update \a index
+    quint32 objectTime(int index)
+    {
+        return m_objectTimes.value(index, getFlightTime());
     }
 
     void setData(const DataFields & data, UAVObjectManager *objectManager);
@@ -63,7 +79,12 @@ signals:
     void LogStringUpdated(QString arg);
 
 private:
-    UAVDataObject *m_object;
+    static const int PACKED_HEADER_SIZE = 10;
+
+    UAVDataObject *createObject(quint32 objectId, quint32 instanceId, const quint8 *data, int size, UAVObjectManager *objectManager);
+
+    QList<UAVDataObject *> m_objects;
+    QList<quint32> m_objectTimes;
 };
 
 class FlightLogManager : public QObject {
@@ -73,6 +94,7 @@ class FlightLogManager : public QObject {
     Q_PROPERTY(bool disableControls READ disableControls WRITE setDisableControls NOTIFY disableControlsChanged)
     Q_PROPERTY(bool disableExport READ disableExport WRITE setDisableExport NOTIFY disableExportChanged)
     Q_PROPERTY(bool adjustExportedTimestamps READ adjustExportedTimestamps WRITE setAdjustExportedTimestamps NOTIFY adjustExportedTimestampsChanged)
+    Q_PROPERTY(QString throughput READ throughput NOTIFY throughputChanged)
 
 public:
     explicit FlightLogManager(QObject *parent = 0);
@@ -103,6 +125,11 @@ public:
         return m_adjustExportedTimestamps;
     }
 
+    QString throughput() const
+    {
+        return m_throughput;
+    }
+
 signals:
     void logEntriesChanged();
     void flightEntriesChanged();
@@ -110,6 +137,7 @@ signals:
     void disableExportChanged(bool arg);
 
     void adjustExportedTimestampsChanged(bool arg);
+    void throughputChanged(QString arg);
 
 public slots:
     void clearAllLogs();
@@ -143,8 +171,19 @@ public slots:
 
 private slots:
     void updateFlightEntries(quint16 currentFlight);
+    void logEntryUnpacked(UAVObject *object);
+    void streamedEntriesQueued();
 
 private:
+    enum EntryResult { ENTRY_FAILED, ENTRY_EMPTY, ENTRY_OK };
+
+    EntryResult retrieveEntry(int flight, int entry, DebugLogEntry::DataFields &data);
+    void retrieveFlightStreamed(int flight);
+    bool streamWindowComplete() const;
+    bool takeStreamedEntries();
+    void addLogEntry(const DebugLogEntry::DataFields &data);
+    void updateThroughput(int entries, int elapsedMs);
+
     UAVObjectManager *m_objectManager;
     DebugLogControl *m_flightLogControl;
     DebugLogStatus *m_flightLogStatus;
@@ -157,6 +196,26 @@ private:
     bool m_disableExport;
     bool m_cancelDownload;
     bool m_adjustExportedTimestamps;
+    QString m_throughput;
+
+    // Streamed retrieval: entries are pushed by the firmware in windows of
+    // up to STREAM_WINDOW, a window ends when it is complete or nothing has
+    // arrived for STREAM_IDLE_TIMEOUT ms. Lost entries are requested again,
+    // after STREAM_MAX_STALLS windows without progress one at a time.
+    static const int STREAM_WINDOW       = 32;
+    static const int STREAM_IDLE_TIMEOUT = 1000;
+    static const int STREAM_MAX_STALLS   = 3;
+    QMap<int, DebugLogEntry::DataFields> m_streamedEntries;
+    // Entries are copied when they are unpacked, in the telemetry thread, as
+    // the next one can overwrite DebugLogEntry before the GUI thread runs
+    QMutex m_streamQueueMutex;
+    QList<DebugLogEntry::DataFields> m_streamQueue;
+    int m_streamFlight;
+    int m_streamEnd; // first entry past the end of the log, -1 while unknown
+    int m_streamWindowFirst;
+    int m_streamWindowEnd;
+    QEventLoop m_streamLoop;
+    QTimer m_streamTimer;
 };
 
 #endif // FLIGHTLOGMANAGER_H
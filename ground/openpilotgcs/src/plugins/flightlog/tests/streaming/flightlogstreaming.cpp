@@ -0,0 +1,206 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogstreaming.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLog FlightLog Plugin
+ * @{
+ * @brief      Test of the streamed flight log retrieval
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../flightlogmanager.h"
+#include "extensionsystem/pluginmanager.h"
+#include "uavtalk/uavtalk.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QBuffer>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+static const int ENTRY_COUNT = 100;
+
+/**
+ * Receiving end of the telemetry link, decodes the stream in the link thread
+ * like a telemetry reader thread would.
+ */
+class Link : public QObject {
+    Q_OBJECT
+
+public:
+    Link(UAVObjectManager *objMngr) : objMngr(objMngr), buffer(NULL), talk(NULL)
+    {}
+
+public slots:
+    void open()
+    {
+        buffer = new QBuffer(this);
+        talk   = new UAVTalk(buffer, objMngr);
+    }
+
+    // All the entries are unpacked back-to-back, before the GUI thread runs
+    void feed(const QByteArray &stream)
+    {
+        buffer->close();
+        buffer->setData(stream);
+        buffer->open(QIODevice::ReadOnly);
+        QMetaObject::invokeMethod(talk, "processInputStream", Qt::DirectConnection);
+    }
+
+    void close()
+    {
+        delete talk;
+        delete buffer;
+        talk   = NULL;
+        buffer = NULL;
+    }
+
+private:
+    UAVObjectManager *objMngr;
+    QBuffer *buffer;
+    UAVTalk *talk;
+};
+
+class tst_FlightLogStreaming : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void backToBackEntries();
+
+public slots:
+    // Flight side of DebugLogControl
+    void controlUpdated(UAVObject *obj);
+
+private:
+    ExtensionSystem::PluginManager *pm;
+    UAVObjectManager *objMngr;
+    UAVObjectManager *sendMngr;
+    DebugLogControl *control;
+    QThread linkThread;
+    Link *link;
+    int refetches;
+};
+
+void tst_FlightLogStreaming::initTestCase()
+{
+    pm = new ExtensionSystem::PluginManager();
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+    pm->addObject(objMngr);
+
+    // Encode the entries with a second set of objects, as the flight side would
+    sendMngr = new UAVObjectManager();
+    UAVObjectsInitialize(sendMngr);
+
+    control = DebugLogControl::GetInstance(objMngr);
+    QVERIFY(control != NULL);
+    connect(control, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(controlUpdated(UAVObject *)), Qt::QueuedConnection);
+
+    link = new Link(objMngr);
+    link->moveToThread(&linkThread);
+    linkThread.start();
+    QMetaObject::invokeMethod(link, "open", Qt::BlockingQueuedConnection);
+}
+
+void tst_FlightLogStreaming::cleanupTestCase()
+{
+    QMetaObject::invokeMethod(link, "close", Qt::BlockingQueuedConnection);
+    linkThread.quit();
+    linkThread.wait();
+    delete link;
+    pm->removeObject(objMngr);
+    delete sendMngr;
+    delete objMngr;
+    delete pm;
+}
+
+void tst_FlightLogStreaming::controlUpdated(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    DebugLogControl::DataFields request = control->getData();
+    if (request.Operation == DebugLogControl::OPERATION_RETRIEVE) {
+        refetches++;
+        control->emitTransactionCompleted(true);
+        return;
+    }
+    if (request.Operation != DebugLogControl::OPERATION_RETRIEVERANGE) {
+        return;
+    }
+    control->emitTransactionCompleted(true);
+
+    DebugLogEntry *sendEntry = DebugLogEntry::GetInstance(sendMngr);
+    QByteArray stream;
+    QBuffer buffer(&stream);
+    buffer.open(QIODevice::WriteOnly);
+    UAVTalk sender(&buffer, sendMngr);
+    for (int entry = request.Entry; entry < request.Entry + request.Count; entry++) {
+        DebugLogEntry::DataFields data;
+        memset(&data, 0, sizeof(data));
+        data.Flight = request.Flight;
+        data.Entry  = entry;
+        if (entry < ENTRY_COUNT) {
+            QByteArray text = QString("entry %1").arg(entry).toLatin1();
+            data.Type = DebugLogEntry::TYPE_TEXT;
+            data.Size = text.size();
+            memcpy(data.Data, text.constData(), text.size());
+        } else {
+            data.Type = DebugLogEntry::TYPE_EMPTY;
+        }
+        sendEntry->setData(data);
+        sender.sendObject(sendEntry, false, false);
+        if (entry >= ENTRY_COUNT) {
+            break;
+        }
+    }
+    QMetaObject::invokeMethod(link, "feed", Qt::BlockingQueuedConnection, Q_ARG(QByteArray, stream));
+}
+
+void tst_FlightLogStreaming::backToBackEntries()
+{
+    refetches = 0;
+
+    FlightLogManager manager;
+    manager.retrieveLogs(0);
+
+    // Every entry arrived with its own data, none had to be fetched again
+    QCOMPARE(refetches, 0);
+    QQmlListProperty<ExtendedDebugLogEntry> entries = manager.logEntries();
+    QCOMPARE(entries.count(&entries), ENTRY_COUNT);
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        ExtendedDebugLogEntry *entry = entries.at(&entries, i);
+        QCOMPARE((int)entry->getEntry(), i);
+        QCOMPARE(entry->getLogString(), QString("entry %1").arg(i));
+    }
+}
+
+QTEST_MAIN(tst_FlightLogStreaming)
+
+#include "flightlogstreaming.moc"
+
+/**
+ * @}
+ * @}
+ */
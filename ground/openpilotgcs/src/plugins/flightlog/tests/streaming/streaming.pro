@@ -0,0 +1,21 @@
+# -------------------------------------------------
+# Flight log streaming test, streams a flight log
+# through a telemetry link decoded outside of the
+# GUI thread
+# -------------------------------------------------
+QT += testlib widgets qml quick network
+TARGET = flightlogstreaming
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../openpilotgcs.pri)
+include(../../../coreplugin/coreplugin.pri)
+include(../../../uavobjects/uavobjects.pri)
+include(../../../uavtalk/uavtalk.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot -L$$GCS_LIBRARY_PATH
+
+HEADERS += ../../flightlogmanager.h
+SOURCES += ../../flightlogmanager.cpp \
+    flightlogstreaming.cpp
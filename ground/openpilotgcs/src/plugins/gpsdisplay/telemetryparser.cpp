@@ -27,6 +27,8 @@
 
 
 #include "telemetryparser.h"
+#include "gpspositionsensor.h"
+#include "gpstime.h"
 #include <math.h>
 #include <QDebug>
 #include <QStringList>
@@ -66,40 +68,39 @@ TelemetryParser::~TelemetryParser()
 
 void TelemetryParser::updateGPS(UAVObject *object1)
 {
-    UAVObjectField *field = object1->getField(QString("Satellites"));
-    emit sv(field->getValue().toInt());
+    GPSPositionSensor *gpsObj = qobject_cast<GPSPositionSensor *>(object1);
 
-    double lat = object1->getField(QString("Latitude"))->getDouble();
-    double lon = object1->getField(QString("Longitude"))->getDouble();
-    double alt = object1->getField(QString("Altitude"))->getDouble();
+    if (!gpsObj) {
+        return;
+    }
+    // Take all the fields at once rather than locking the object for each of them
+    GPSPositionSensor::DataFields gpsData = gpsObj->getData();
+
+    emit sv(gpsData.Satellites);
 
-    lat *= 1E-7;
-    lon *= 1E-7;
-    emit position(lat, lon, alt);
+    double lat = gpsData.Latitude * 1E-7;
+    double lon = gpsData.Longitude * 1E-7;
+    emit position(lat, lon, gpsData.Altitude);
 
-    double hdg  = object1->getField(QString("Heading"))->getDouble();
-    double spd  = object1->getField(QString("Groundspeed"))->getDouble();
-    emit speedheading(spd, hdg);
+    emit speedheading(gpsData.Groundspeed, gpsData.Heading);
 
-    QString fix = object1->getField(QString("Status"))->getValue().toString();
-    emit fixtype(fix);
+    QStringList statusOptions = object1->getField(QString("Status"))->getOptions();
+    emit fixtype(gpsData.Status < statusOptions.size() ? statusOptions.at(gpsData.Status) : QString());
 
-    double hdop = object1->getField(QString("HDOP"))->getDouble();
-    double vdop = object1->getField(QString("VDOP"))->getDouble();
-    double pdop = object1->getField(QString("PDOP"))->getDouble();
-    emit dop(hdop, vdop, pdop);
+    emit dop(gpsData.HDOP, gpsData.VDOP, gpsData.PDOP);
 }
 
 void TelemetryParser::updateTime(UAVObject *object1)
 {
-    double hour   = object1->getField(QString("Hour"))->getDouble();
-    double minute = object1->getField(QString("Minute"))->getDouble();
-    double second = object1->getField(QString("Second"))->getDouble();
-    double time   = second + minute * 100 + hour * 10000;
-    double year   = object1->getField(QString("Year"))->getDouble();
-    double month  = object1->getField(QString("Month"))->getDouble();
-    double day    = object1->getField(QString("Day"))->getDouble();
-    double date   = day + month * 100 + year * 10000;
+    GPSTime *timeObj = qobject_cast<GPSTime *>(object1);
+
+    if (!timeObj) {
+        return;
+    }
+    GPSTime::DataFields timeData = timeObj->getData();
+
+    double time = timeData.Second + timeData.Minute * 100 + timeData.Hour * 10000;
+    double date = timeData.Day + timeData.Month * 100 + (double)timeData.Year * 10000;
     emit datetime(date, time);
 }
 
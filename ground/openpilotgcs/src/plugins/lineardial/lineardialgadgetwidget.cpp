@@ -137,10 +137,10 @@ void LineardialGadgetWidget::updateIndex(UAVObject *object1)
             if (fieldSymbol) {
                 // If we defined a symbol, we will look for a matching
                 // SVG element to display:
-                if (m_renderer->elementExists("symbol-" + s)) {
-                    fieldSymbol->setElementId("symbol-" + s);
-                } else {
-                    fieldSymbol->setElementId("symbol");
+                QString symbol = m_renderer->elementExists("symbol-" + s) ? "symbol-" + s : "symbol";
+                // Changing the element re-renders the cached symbol
+                if (fieldSymbol->elementId() != symbol) {
+                    fieldSymbol->setElementId(symbol);
                 }
             }
         }
@@ -171,7 +171,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
     if (QFile::exists(dfn) && m_renderer->load(dfn) && m_renderer->isValid()) {
         l_scene->clear(); // Beware: clear also deletes all objects
                           // which are currently in the scene
-        background = new QGraphicsSvgItem();
+        background = new CachedSvgItem();
         background->setSharedRenderer(m_renderer);
         background->setElementId("background");
         background->setFlags(QGraphicsItem::ItemClipsChildrenToShape |
@@ -183,15 +183,15 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         if (m_renderer->elementExists("red")) {
             // Order is important: red, then yellow then green
             // overlayed on top of each other
-            red = new QGraphicsSvgItem();
+            red = new CachedSvgItem();
             red->setSharedRenderer(m_renderer);
             red->setElementId("red");
             red->setParentItem(background);
-            yellow = new QGraphicsSvgItem();
+            yellow = new CachedSvgItem();
             yellow->setSharedRenderer(m_renderer);
             yellow->setElementId("yellow");
             yellow->setParentItem(background);
-            green = new QGraphicsSvgItem();
+            green = new CachedSvgItem();
             green->setSharedRenderer(m_renderer);
             green->setElementId("green");
             green->setParentItem(background);
@@ -268,7 +268,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
             startY = nRect.y();
             QTransform matrix;
             matrix.translate(startX, startY);
-            index  = new QGraphicsSvgItem();
+            index  = new CachedSvgItem();
             index->setSharedRenderer(m_renderer);
             index->setElementId("needle");
             index->setTransform(matrix, false);
@@ -321,7 +321,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
             qreal startY = textMatrix.mapRect(m_renderer->boundsOnElement("symbol")).y();
             QTransform matrix;
             matrix.translate(startX, startY);
-            fieldSymbol = new QGraphicsSvgItem();
+            fieldSymbol = new CachedSvgItem();
             fieldSymbol->setElementId("symbol");
             fieldSymbol->setSharedRenderer(m_renderer);
             fieldSymbol->setTransform(matrix, false);
@@ -331,7 +331,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         }
 
         if (m_renderer->elementExists("foreground")) {
-            foreground = new QGraphicsSvgItem();
+            foreground = new CachedSvgItem();
             foreground->setSharedRenderer(m_renderer);
             foreground->setElementId("foreground");
             foreground->setParentItem(background);
@@ -351,7 +351,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         qDebug() << "no file ";
         m_renderer->load(QString(":/lineardial/images/empty.svg"));
         l_scene->clear(); // This also deletes all items contained in the scene.
-        background  = new QGraphicsSvgItem();
+        background  = new CachedSvgItem();
         background->setSharedRenderer(m_renderer);
         l_scene->addItem(background);
         fieldName   = NULL;
@@ -35,6 +35,7 @@
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
+#include <utils/cachedsvgitem.h>
 
 #include <QFile>
 #include <QTimer>
@@ -91,13 +92,13 @@ private slots:
 
 private:
     QSvgRenderer *m_renderer;
-    QGraphicsSvgItem *background;
-    QGraphicsSvgItem *foreground;
-    QGraphicsSvgItem *index;
-    QGraphicsSvgItem *green;
-    QGraphicsSvgItem *yellow;
-    QGraphicsSvgItem *red;
-    QGraphicsSvgItem *fieldSymbol;
+    CachedSvgItem *background;
+    CachedSvgItem *foreground;
+    CachedSvgItem *index;
+    CachedSvgItem *green;
+    CachedSvgItem *yellow;
+    CachedSvgItem *red;
+    CachedSvgItem *fieldSymbol;
 
     QGraphicsTextItem *fieldName;
     QGraphicsTextItem *fieldValue;
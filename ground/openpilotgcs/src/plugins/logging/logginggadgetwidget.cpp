@@ -33,6 +33,7 @@
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QPushButton>
+#include <QTime>
 #include <loggingplugin.h>
 
 LoggingGadgetWidget::LoggingGadgetWidget(QWidget *parent) : QLabel(parent)
@@ -58,6 +59,10 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin *p)
     connect(m_logging->pauseButton, SIGNAL(clicked()), p->getLogfile(), SLOT(pauseReplay()));
     connect(m_logging->pauseButton, SIGNAL(clicked()), scpPlugin, SLOT(stopPlotting()));
     connect(m_logging->playbackSpeed, SIGNAL(valueChanged(double)), p->getLogfile(), SLOT(setReplaySpeed(double)));
+    connect(m_logging->fastReplay, SIGNAL(toggled(bool)), p->getLogConnection(), SLOT(setFastReplay(bool)));
+    connect(m_logging->positionSlider, SIGNAL(sliderMoved(int)), p->getLogConnection(), SLOT(setReplayPosition(int)));
+    connect(p->getLogConnection(), SIGNAL(replayPositionChanged(int)), this, SLOT(replayPositionChanged(int)));
+    connect(p->getLogfile(), SIGNAL(replayStarted()), this, SLOT(replayStarted()));
     void pauseReplay();
     void resumeReplay();
 }
@@ -68,6 +73,21 @@ void LoggingGadgetWidget::stateChanged(QString status)
     m_logging->statusLabel->setText(status);
 }
 
+void LoggingGadgetWidget::replayStarted()
+{
+    m_logging->positionSlider->setRange(0, loggingPlugin->getLogConnection()->replayDuration());
+    replayPositionChanged(0);
+}
+
+void LoggingGadgetWidget::replayPositionChanged(int position)
+{
+    if (!m_logging->positionSlider->isSliderDown()) {
+        m_logging->positionSlider->setValue(position);
+    }
+    QTime time = QTime(0, 0).addMSecs(position);
+    m_logging->positionLabel->setText(time.toString("hh:mm:ss"));
+}
+
 /**
  * @}
  * @}
@@ -47,6 +47,8 @@ public:
 
 protected slots:
     void stateChanged(QString status);
+    void replayStarted();
+    void replayPositionChanged(int position);
 
 signals:
     void pause();
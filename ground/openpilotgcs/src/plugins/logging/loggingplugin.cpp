@@ -47,7 +47,11 @@
 LoggingConnection::LoggingConnection(LoggingPlugin *loggingPlugin) :
     loggingPlugin(loggingPlugin),
     m_deviceOpened(false)
-{}
+{
+    // Multi-hour logs are only indexed once
+    logFile.setPersistentIndex(true);
+    connect(&logFile, SIGNAL(replayPositionChanged(int)), this, SIGNAL(replayPositionChanged(int)));
+}
 
 LoggingConnection::~LoggingConnection()
 {}
@@ -90,6 +94,24 @@ void LoggingConnection::startReplay(QString file)
     }
 }
 
+/**
+ * Seek the replay to position (in ms from the start of the log), forwards or backwards
+ */
+void LoggingConnection::setReplayPosition(int position)
+{
+    if (logFile.isOpen()) {
+        logFile.setReplayPosition(position);
+    }
+}
+
+/**
+ * Replay as fast as possible instead of at the playback speed, for batch analysis
+ */
+void LoggingConnection::setFastReplay(bool fastReplay)
+{
+    logFile.setFastReplay(fastReplay);
+}
+
 void LoggingConnection::closeDevice(const QString &deviceName)
 {
     Q_UNUSED(deviceName);
@@ -72,6 +72,22 @@ public:
         return &logFile;
     }
 
+    // Replay position and length of the replayed log in ms
+    int replayPosition() const
+    {
+        return logFile.replayPosition();
+    }
+    int replayDuration() const
+    {
+        return logFile.replayDuration();
+    }
+
+public slots:
+    void setReplayPosition(int position);
+    void setFastReplay(bool fastReplay);
+
+signals:
+    void replayPositionChanged(int position);
 
 private:
     LogFile logFile;
@@ -29,10 +29,12 @@
 #include "ophid_const.h"
 #include "coreplugin/connectionmanager.h"
 #include <extensionsystem/pluginmanager.h>
+#include <utils/ringbuffer.h>
 #include <QtGlobal>
 #include <QList>
 #include <QMutexLocker>
 #include <QWaitCondition>
+#include <QAtomicInt>
 
 class IConnection;
 
@@ -43,6 +45,10 @@ static const int READ_SIZE     = 64;
 static const int WRITE_TIMEOUT = 1000;
 static const int WRITE_SIZE    = 64;
 
+// buffered bytes in each direction, a few seconds of a full speed link
+static const int READ_BUFFER_SIZE  = 256 * 1024;
+static const int WRITE_BUFFER_SIZE = 256 * 1024;
+
 
 // *********************************************************************************
 
@@ -54,7 +60,7 @@ public:
     RawHIDReadThread(RawHID *hid);
     virtual ~RawHIDReadThread();
 
-    /** Return the data read so far without waiting */
+    /** Return the data read so far without waiting, called by the reader of the device only */
     int getReadData(char *data, int size);
 
     /** return the bytes buffered */
@@ -69,12 +75,11 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_readBuffer;
+    /** Filled by this thread, emptied by the reader of the device */
+    Utils::RingBuffer m_readBuffer;
 
-    /** A mutex to protect read buffer */
-    QMutex m_readBufMtx;
+    /** Set while a readyRead() is pending, so that a burst of reports is notified once */
+    QAtomicInt m_readyReadPending;
 
     RawHID *m_hid;
 
@@ -95,7 +100,7 @@ public:
     RawHIDWriteThread(RawHID *hid);
     virtual ~RawHIDWriteThread();
 
-    /** Add some data to be written without waiting */
+    /** Add some data to be written, waiting for room in the buffer if needed */
     int pushDataToWrite(const char *data, int size);
 
     /** Return the number of bytes buffered */
@@ -110,11 +115,10 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_writeBuffer;
+    /** Filled by the writer of the device, emptied by this thread */
+    Utils::RingBuffer m_writeBuffer;
 
-    /** A mutex to protect read buffer */
+    /** Only used to sleep until new data arrives, the buffer itself is lock free */
     QMutex m_writeBufMtx;
 
     /** Synchronize task with data arival */
@@ -131,7 +135,9 @@ protected:
 // *********************************************************************************
 
 RawHIDReadThread::RawHIDReadThread(RawHID *hid)
-    : m_hid(hid),
+    : m_readBuffer(READ_BUFFER_SIZE),
+    m_readyReadPending(0),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
@@ -169,12 +175,24 @@ void RawHIDReadThread::run()
         int ret = hiddev->receive(hidno, buffer, READ_SIZE, READ_TIMEOUT);
 
         if (ret > 0) { // read some data
-            QMutexLocker lock(&m_readBufMtx);
             // Note: Preprocess the USB packets in this OS independent code
             // First byte is report ID, second byte is the number of valid bytes
-            m_readBuffer.append(&buffer[2], buffer[1]);
+            int size = qBound(0, (int)buffer[1], READ_SIZE - 2);
+            int pos  = 0;
+            while (m_running && pos < size) {
+                // when the reader falls behind wait for it rather than dropping data
+                int written = m_readBuffer.write(&buffer[2 + pos], size - pos);
+                if (written == 0) {
+                    msleep(1);
+                }
+                pos += written;
+            }
 
-            emit m_hid->readyRead();
+            // the reader clears the flag when it takes data, until then
+            // the reports that follow are covered by the same notification
+            if (m_readyReadPending.testAndSetOrdered(0, 1)) {
+                emit m_hid->readyRead();
+            }
         } else if (ret == 0) { // nothing read
         } else { // < 0 => error
                  // TODO! make proper error handling, this only quick hack for unplug freeze
@@ -188,27 +206,22 @@ void RawHIDReadThread::run()
 
 int RawHIDReadThread::getReadData(char *data, int size)
 {
-    QMutexLocker lock(&m_readBufMtx);
+    // cleared before reading so that data arriving from now on is notified again
+    m_readyReadPending.fetchAndStoreOrdered(0);
 
-    size = qMin(size, m_readBuffer.size());
-
-    memcpy(data, m_readBuffer.constData(), size);
-    m_readBuffer.remove(0, size);
-
-    return size;
+    return m_readBuffer.read(data, size);
 }
 
 qint64 RawHIDReadThread::getBytesAvailable()
 {
-    QMutexLocker lock(&m_readBufMtx);
-
     return m_readBuffer.size();
 }
 
 // *********************************************************************************
 
 RawHIDWriteThread::RawHIDWriteThread(RawHID *hid)
-    : m_hid(hid),
+    : m_writeBuffer(WRITE_BUFFER_SIZE),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
@@ -229,36 +242,31 @@ void RawHIDWriteThread::run()
         char buffer[WRITE_SIZE] = { 0 };
         int size;
 
-        {
+        if (m_writeBuffer.isEmpty()) {
             QMutexLocker lock(&m_writeBufMtx);
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            while (size <= 0) {
+            while (m_writeBuffer.isEmpty()) {
                 // wait on new data to write condition, the timeout
                 // enable the thread to shutdown properly
                 m_newDataToWrite.wait(&m_writeBufMtx, 200);
                 if (!m_running) {
                     return;
                 }
-
-                size = m_writeBuffer.size();
             }
-
-            // NOTE: data size is limited to 2 bytes less than the
-            // usb packet size (64 bytes for interrupt) to make room
-            // for the reportID and valid data length
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            memcpy(&buffer[2], m_writeBuffer.constData(), size);
-            buffer[1] = size; // valid data length
-            buffer[0] = 2; // reportID
         }
 
-        // must hold lock through the send to know how much was sent
+        // NOTE: data size is limited to 2 bytes less than the
+        // usb packet size (64 bytes for interrupt) to make room
+        // for the reportID and valid data length
+        size = m_writeBuffer.peek(&buffer[2], WRITE_SIZE - 2);
+        buffer[1] = size; // valid data length
+        buffer[0] = 2; // reportID
+
+        // the data stays buffered through the send to know how much was sent
         int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
 
         if (ret > 0) {
             // only remove the size actually written to the device
-            QMutexLocker lock(&m_writeBufMtx);
-            m_writeBuffer.remove(0, size);
+            m_writeBuffer.skip(size);
 
             emit m_hid->bytesWritten(ret - 2);
         } else if (ret < 0) { // < 0 => error
@@ -273,17 +281,32 @@ void RawHIDWriteThread::run()
 
 int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 {
-    QMutexLocker lock(&m_writeBufMtx);
-
-    m_writeBuffer.append(data, size);
-    m_newDataToWrite.wakeOne(); // signal that new data arrived
+    int pos = 0;
+
+    // writers are serialized by RawHID::writeData. When the buffer is full wait
+    // for this thread to send some of it rather than cutting a packet short,
+    // unless the thread has stopped and the data would never be sent anyway.
+    while (pos < size) {
+        int written = m_writeBuffer.write(&data[pos], size - pos);
+        pos += written;
+
+        QMutexLocker lock(&m_writeBufMtx);
+        m_newDataToWrite.wakeOne(); // signal that new data arrived
+        lock.unlock();
+
+        if (written == 0) {
+            if (!m_running || !isRunning()) {
+                break;
+            }
+            msleep(1);
+        }
+    }
 
-    return size;
+    return pos;
 }
 
 qint64 RawHIDWriteThread::getBytesToWrite()
 {
-    // QMutexLocker lock(&m_writeBufMtx);
     return m_writeBuffer.size();
 }
 
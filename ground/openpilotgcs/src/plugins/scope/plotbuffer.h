@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotbuffer.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTBUFFER_H
+#define PLOTBUFFER_H
+
+#include <QVector>
+
+/*!
+   \brief Circular buffer of plot samples.
+
+   Appending and removing the oldest sample are O(1). The storage is a power
+   of two so that wrapping is a mask; it only grows when an append finds the
+   buffer full, which stops happening once the plot window has filled up.
+ */
+class PlotBuffer {
+public:
+    PlotBuffer(int capacity = 64)
+        : m_head(0), m_size(0)
+    {
+        int n = 1;
+
+        while (n < capacity) {
+            n <<= 1;
+        }
+        m_data.resize(n);
+        m_mask = n - 1;
+    }
+
+    int size() const
+    {
+        return m_size;
+    }
+
+    int capacity() const
+    {
+        return m_data.size();
+    }
+
+    bool isEmpty() const
+    {
+        return m_size == 0;
+    }
+
+    /*!
+       \brief Sample \a i, counting from the oldest one.
+     */
+    double at(int i) const
+    {
+        return m_data.at((m_head + i) & m_mask);
+    }
+
+    double first() const
+    {
+        return at(0);
+    }
+
+    double last() const
+    {
+        return at(m_size - 1);
+    }
+
+    void append(double value)
+    {
+        if (m_size == m_data.size()) {
+            grow();
+        }
+        m_data[(m_head + m_size) & m_mask] = value;
+        m_size++;
+    }
+
+    void popFront()
+    {
+        if (m_size > 0) {
+            m_head = (m_head + 1) & m_mask;
+            m_size--;
+        }
+    }
+
+    void clear()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+private:
+    void grow()
+    {
+        QVector<double> data(m_data.size() * 2);
+
+        for (int i = 0; i < m_size; i++) {
+            data[i] = at(i);
+        }
+        m_data = data;
+        m_mask = m_data.size() - 1;
+        m_head = 0;
+    }
+
+    QVector<double> m_data;
+    int m_mask;
+    int m_head;
+    int m_size;
+};
+
+#endif // PLOTBUFFER_H
@@ -44,171 +44,247 @@ PlotData::PlotData(QString p_uavObject, QString p_uavField)
         haveSubField = false;
     }
 
-    xData           = new QVector<double>();
-    yData           = new QVector<double>();
-    yDataHistory    = new QVector<double>();
+    xData           = new PlotBuffer();
+    yData           = new PlotBuffer();
+    yPyramid        = new PlotPyramid();
+    yDataHistory    = new PlotBuffer();
+    seriesData      = 0;
 
     curve           = 0;
     scalePower      = 0;
-    meanSamples = 1;
-    meanSum         = 0.0f;
-// mathFunction=0;
-    correctionSum   = 0.0f;
-    correctionCount = 0;
+    meanSamples     = 1;
+    mathFunction    = MathNone;
     yMinimum        = 0;
     yMaximum        = 0;
 
     m_xWindowSize   = 0;
+
+    m_object        = 0;
+    m_field         = 0;
+    m_elementIndex  = 0;
+    m_scale         = 1.0;
+
+    resetStatistics();
 }
 
-double PlotData::valueAsDouble(UAVObject *obj, UAVObjectField *field)
+void PlotData::setMathFunction(const QString &name)
 {
-    Q_UNUSED(obj);
-    QVariant value;
+    if (name == "Boxcar average") {
+        mathFunction = MathBoxcarAverage;
+    } else if (name == "Standard deviation") {
+        mathFunction = MathStandardDeviation;
+    } else {
+        mathFunction = MathNone;
+    }
+    resetStatistics();
+}
 
-    if (haveSubField) {
-        int indexOfSubField = field->getElementNames().indexOf(QRegExp(uavSubField, Qt::CaseSensitive, QRegExp::FixedString));
-        value = field->getValue(indexOfSubField);
+void PlotData::resetStatistics()
+{
+    yDataHistory->clear();
+    historyMean     = 0.0;
+    historyM2       = 0.0;
+    correctionCount = 0;
+}
+
+double PlotData::applyMathFunction(double value)
+{
+    if (mathFunction == MathNone) {
+        return value;
+    }
+
+    // Welford's running mean and variance over the last meanSamples values
+    int window = qMax(meanSamples, 1);
+    int n = yDataHistory->size();
+    if (n < window) {
+        yDataHistory->append(value);
+        n++;
+        double delta = value - historyMean;
+        historyMean += delta / n;
+        historyM2   += delta * (value - historyMean);
     } else {
-        value = field->getValue();
+        // The window is full, so the new value replaces the oldest one
+        double oldest  = yDataHistory->first();
+        double oldMean = historyMean;
+        yDataHistory->popFront();
+        yDataHistory->append(value);
+        historyMean += (value - oldest) / n;
+        historyM2   += (value - oldest) * (value - historyMean + oldest - oldMean);
     }
 
-    // qDebug() << "Data  (" << value.typeName() << ") " <<  value.toString();
+    // make sure to recompute the statistics every meanSamples steps to prevent them
+    // from running away due to floating point rounding errors
+    if (++correctionCount >= window) {
+        double sum = 0.0;
+        for (int i = 0; i < n; i++) {
+            sum += yDataHistory->at(i);
+        }
+        historyMean = sum / n;
+        historyM2   = 0.0;
+        for (int i = 0; i < n; i++) {
+            double delta = yDataHistory->at(i) - historyMean;
+            historyM2 += delta * delta;
+        }
+        correctionCount = 0;
+    }
 
-    return value.toDouble();
+    if (mathFunction == MathStandardDeviation) {
+        // Sample standard deviation, with Bessel's correction
+        return n > 1 ? sqrt(qMax(historyM2, 0.0) / (n - 1)) : 0.0;
+    }
+    return historyMean;
+}
+
+void PlotData::updatePlotCurveData(int pixelWidth)
+{
+    if (!curve) {
+        return;
+    }
+
+    if (!seriesData) {
+        seriesData = new PlotSeriesData(this);
+        seriesData->update(pixelWidth);
+        curve->setData(seriesData);
+    } else {
+        seriesData->update(pixelWidth);
+        curve->itemChanged();
+    }
+}
+
+bool PlotData::bind(UAVObject *obj)
+{
+    m_object = obj;
+    m_field  = obj ? obj->getField(uavField) : 0;
+    if (!m_field) {
+        return false;
+    }
+
+    m_elementIndex = 0;
+    if (haveSubField) {
+        int indexOfSubField = m_field->getElementNames().indexOf(QRegExp(uavSubField, Qt::CaseSensitive, QRegExp::FixedString));
+        if (indexOfSubField < 0) {
+            m_field = 0;
+            return false;
+        }
+        m_elementIndex = indexOfSubField;
+    }
+    m_scale = pow(10, scalePower);
+
+    return true;
+}
+
+double PlotData::boundValue()
+{
+    return m_field->getDouble(m_elementIndex) * m_scale;
 }
 
 PlotData::~PlotData()
 {
     delete xData;
     delete yData;
+    delete yPyramid;
     delete yDataHistory;
 }
 
+void PlotSeriesData::update(int pixelWidth)
+{
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
 
-bool SequentialPlotData::append(UAVObject *obj)
+    int samples = qMin(m_plotData->xData->size(), m_plotData->yData->size());
+    m_decimated = pixelWidth > 0 && samples > 2 * pixelWidth;
+    if (m_decimated) {
+        m_plotData->yPyramid->decimate(*m_plotData->xData, *m_plotData->yData, pixelWidth, m_points);
+    } else {
+        m_points.clear();
+    }
+}
+
+size_t PlotSeriesData::size() const
+{
+    if (m_decimated) {
+        return m_points.size();
+    }
+    return qMin(m_plotData->xData->size(), m_plotData->yData->size());
+}
+
+QPointF PlotSeriesData::sample(size_t i) const
 {
-    if (uavObject == obj->getName()) {
-        // Get the field of interest
-        UAVObjectField *field = obj->getField(uavField);
-
-        if (field) {
-            double currentValue = valueAsDouble(obj, field) * pow(10, scalePower);
-
-            // Perform scope math, if necessary
-            if (mathFunction == "Boxcar average" || mathFunction == "Standard deviation") {
-                // Put the new value at the front
-                yDataHistory->append(currentValue);
-
-                // calculate average value
-                meanSum += currentValue;
-                if (yDataHistory->size() > meanSamples) {
-                    meanSum -= yDataHistory->first();
-                    yDataHistory->pop_front();
-                }
-
-                // make sure to correct the sum every meanSamples steps to prevent it
-                // from running away due to floating point rounding errors
-                correctionSum += currentValue;
-                if (++correctionCount >= meanSamples) {
-                    meanSum = correctionSum;
-                    correctionSum = 0.0f;
-                    correctionCount = 0;
-                }
-
-                double boxcarAvg = meanSum / yDataHistory->size();
-
-                if (mathFunction == "Standard deviation") {
-                    // Calculate square of sample standard deviation, with Bessel's correction
-                    double stdSum = 0;
-                    for (int i = 0; i < yDataHistory->size(); i++) {
-                        stdSum += pow(yDataHistory->at(i) - boxcarAvg, 2) / (meanSamples - 1);
-                    }
-                    yData->append(sqrt(stdSum));
-                } else {
-                    yData->append(boxcarAvg);
-                }
-            } else {
-                yData->append(currentValue);
-            }
-
-            if (yData->size() > m_xWindowSize) { // If new data overflows the window, remove old data...
-                yData->pop_front();
-            } else { // ...otherwise, add a new y point at position xData
-                xData->insert(xData->size(), xData->size());
-            }
-
-            // notify the gui of changes in the data
-            // dataChanged();
-            return true;
+    if (m_decimated) {
+        return m_points.at(i);
+    }
+    return QPointF(m_plotData->xData->at(i), m_plotData->yData->at(i));
+}
+
+QRectF PlotSeriesData::boundingRect() const
+{
+    if (d_boundingRect.width() < 0.0) {
+        // The min/max envelope has the same extent as the samples it stands for
+        int n = size();
+        if (n == 0) {
+            return d_boundingRect;
+        }
+
+        QPointF point = sample(0);
+        double minX   = point.x();
+        double maxX   = minX;
+        double minY   = point.y();
+        double maxY   = minY;
+        for (int i = 1; i < n; i++) {
+            point = sample(i);
+            minX  = qMin(minX, point.x());
+            maxX  = qMax(maxX, point.x());
+            minY  = qMin(minY, point.y());
+            maxY  = qMax(maxY, point.y());
         }
+        d_boundingRect = QRectF(minX, minY, maxX - minX, maxY - minY);
+    }
+    return d_boundingRect;
+}
+
+
+bool SequentialPlotData::append(UAVObject *obj)
+{
+    if (obj != m_object || !m_field) {
+        return false;
     }
 
-    return false;
+    double y = applyMathFunction(boundValue());
+    yData->append(y);
+    yPyramid->append(y);
+
+    if (yData->size() > m_xWindowSize) { // If new data overflows the window, remove old data...
+        yData->popFront();
+        yPyramid->popFront();
+    } else { // ...otherwise, add a new y point at position xData
+        xData->append(xData->size());
+    }
+
+    // notify the gui of changes in the data
+    // dataChanged();
+    return true;
 }
 
 bool ChronoPlotData::append(UAVObject *obj)
 {
-    if (uavObject == obj->getName()) {
-        // Get the field of interest
-        UAVObjectField *field = obj->getField(uavField);
-        // qDebug() << "uavObject: " << uavObject << ", uavField: " << uavField;
-
-        if (field) {
-            QDateTime NOW = QDateTime::currentDateTime(); // THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
-            double currentValue = valueAsDouble(obj, field) * pow(10, scalePower);
-
-            // Perform scope math, if necessary
-            if (mathFunction == "Boxcar average" || mathFunction == "Standard deviation") {
-                // Put the new value at the back
-                yDataHistory->append(currentValue);
-
-                // calculate average value
-                meanSum += currentValue;
-                if (yDataHistory->size() > meanSamples) {
-                    meanSum -= yDataHistory->first();
-                    yDataHistory->pop_front();
-                }
-                // make sure to correct the sum every meanSamples steps to prevent it
-                // from running away due to floating point rounding errors
-                correctionSum += currentValue;
-                if (++correctionCount >= meanSamples) {
-                    meanSum = correctionSum;
-                    correctionSum = 0.0f;
-                    correctionCount = 0;
-                }
-
-                double boxcarAvg = meanSum / yDataHistory->size();
-// qDebug()<<mathFunction;
-                if (mathFunction == "Standard deviation") {
-                    // Calculate square of sample standard deviation, with Bessel's correction
-                    double stdSum = 0;
-                    for (int i = 0; i < yDataHistory->size(); i++) {
-                        stdSum += pow(yDataHistory->at(i) - boxcarAvg, 2) / (meanSamples - 1);
-                    }
-                    yData->append(sqrt(stdSum));
-                } else {
-                    yData->append(boxcarAvg);
-                }
-            } else {
-                yData->append(currentValue);
-            }
-
-            double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
-            xData->append(valueX);
-
-            // qDebug() << "Data  " << uavObject << "." << field->getName() << " X,Y:" << valueX << "," <<  valueY;
-
-            // Remove stale data
-            removeStaleData();
-
-            // notify the gui of chages in the data
-            // dataChanged();
-            return true;
-        }
+    if (obj != m_object || !m_field) {
+        return false;
     }
 
-    return false;
+    QDateTime NOW = QDateTime::currentDateTime(); // THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
+
+    double y = applyMathFunction(boundValue());
+    yData->append(y);
+    yPyramid->append(y);
+
+    double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
+    xData->append(valueX);
+
+    // Remove stale data
+    removeStaleData();
+
+    // notify the gui of chages in the data
+    // dataChanged();
+    return true;
 }
 
 void ChronoPlotData::removeStaleData()
@@ -225,8 +301,9 @@ void ChronoPlotData::removeStaleData()
         oldestValue = xData->first();
 
         if (newestValue - oldestValue > m_xWindowSize) {
-            yData->pop_front();
-            xData->pop_front();
+            yData->popFront();
+            yPyramid->popFront();
+            xData->popFront();
         } else {
             break;
         }
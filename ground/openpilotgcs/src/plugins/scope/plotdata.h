@@ -29,12 +29,15 @@
 #define PLOTDATA_H
 
 #include "uavobject.h"
+#include "plotbuffer.h"
+#include "plotpyramid.h"
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_plot.h"
 #include "qwt/src/qwt_plot_curve.h"
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
+#include "qwt/src/qwt_series_data.h"
 
 #include <QTimer>
 #include <QTime>
@@ -51,6 +54,44 @@ enum PlotType {
     NPlotTypes
 };
 
+/*!
+   \brief Math applied to the samples of a curve before they are plotted.
+ */
+enum PlotMathFunction {
+    MathNone,
+    MathBoxcarAverage,
+    MathStandardDeviation
+};
+
+class PlotData;
+
+/*!
+   \brief Lets Qwt read the samples straight out of the PlotData buffers, without
+   copying them into a QVector on every replot.
+
+   When the window holds more than two samples per horizontal pixel, the curve
+   is drawn from the min/max envelope of the PlotData pyramid instead.
+ */
+class PlotSeriesData : public QwtSeriesData<QPointF> {
+public:
+    PlotSeriesData(const PlotData *plotData) : m_plotData(plotData), m_decimated(false) {}
+
+    virtual size_t size() const;
+    virtual QPointF sample(size_t i) const;
+    virtual QRectF boundingRect() const;
+
+    /*!
+       \brief Refreshes the series after the buffers changed, for a canvas
+       \a pixelWidth pixels wide (0 when unknown).
+     */
+    void update(int pixelWidth);
+
+private:
+    const PlotData *m_plotData;
+    bool m_decimated;
+    QVector<QPointF> m_points;
+};
+
 /*!
    \brief Base class that keeps the data for each curve in the plot.
  */
@@ -67,26 +108,41 @@ public:
     bool haveSubField;
     int scalePower; // This is the power to which each value must be raised
     int meanSamples;
-    double meanSum;
-    QString mathFunction;
-    double correctionSum;
-    int correctionCount;
+    PlotMathFunction mathFunction;
     double yMinimum;
     double yMaximum;
     double m_xWindowSize;
     QwtPlotCurve *curve;
-    QVector<double> *xData;
-    QVector<double> *yData;
-    QVector<double> *yDataHistory;
+    PlotBuffer *xData;
+    PlotBuffer *yData;
+    PlotPyramid *yPyramid;
 
     virtual bool append(UAVObject *obj) = 0;
     virtual PlotType plotType()    = 0;
     virtual void removeStaleData() = 0;
 
-    void updatePlotCurveData();
+    bool bind(UAVObject *obj);
+    void setMathFunction(const QString &name);
+    void updatePlotCurveData(int pixelWidth = 0);
 
 protected:
-    double valueAsDouble(UAVObject *obj, UAVObjectField *field);
+    double boundValue();
+    double applyMathFunction(double value);
+
+    // Resolved once by bind(), so appending does no name lookups
+    UAVObject *m_object;
+    UAVObjectField *m_field;
+    quint32 m_elementIndex;
+    double m_scale;
+
+private:
+    void resetStatistics();
+
+    PlotBuffer *yDataHistory;
+    PlotSeriesData *seriesData; // Owned by the curve
+    double historyMean;
+    double historyM2; // Sum of squared differences from historyMean
+    int correctionCount;
 
 signals:
     void dataChanged();
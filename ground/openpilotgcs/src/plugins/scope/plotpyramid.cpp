@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotpyramid.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "plotpyramid.h"
+
+PlotPyramid::PlotPyramid()
+    : m_count(0), m_dropped(0)
+{}
+
+void PlotPyramid::append(double value)
+{
+    m_count++;
+    merge(0, value, value);
+}
+
+void PlotPyramid::popFront()
+{
+    if (m_dropped >= m_count) {
+        return;
+    }
+    m_dropped++;
+
+    qint64 bucketSize = BASE_BUCKET_SIZE;
+    for (int i = 0; i < m_levels.size(); i++) {
+        trim(m_levels[i], bucketSize);
+        bucketSize <<= 1;
+    }
+}
+
+void PlotPyramid::clear()
+{
+    m_levels.clear();
+    m_count   = 0;
+    m_dropped = 0;
+}
+
+void PlotPyramid::merge(int level, double min, double max)
+{
+    if (level >= MAX_LEVELS) {
+        return;
+    }
+    if (level == m_levels.size()) {
+        m_levels.append(Level());
+    }
+
+    Level &l = m_levels[level];
+    if (l.pendingCount == 0) {
+        l.pendingMin = min;
+        l.pendingMax = max;
+    } else {
+        l.pendingMin = qMin(l.pendingMin, min);
+        l.pendingMax = qMax(l.pendingMax, max);
+    }
+
+    // Level 0 buckets are filled with samples, the others with two child buckets
+    if (++l.pendingCount < (level == 0 ? BASE_BUCKET_SIZE : 2)) {
+        return;
+    }
+
+    min = l.pendingMin;
+    max = l.pendingMax;
+    l.pendingCount = 0;
+    l.min.append(min);
+    l.max.append(max);
+    trim(l, (qint64)BASE_BUCKET_SIZE << level);
+
+    merge(level + 1, min, max);
+}
+
+void PlotPyramid::trim(Level &level, qint64 bucketSize)
+{
+    // Drop buckets that contain samples which already left the window
+    while (!level.min.isEmpty() && level.first * bucketSize < m_dropped) {
+        level.min.popFront();
+        level.max.popFront();
+        level.first++;
+    }
+    if (level.min.isEmpty()) {
+        // Keep the index aligned with the next bucket that will be stored
+        level.first = m_count / bucketSize;
+    }
+}
+
+void PlotPyramid::decimate(const PlotBuffer &xData, const PlotBuffer &yData, int maxBuckets, QVector<QPointF> &points) const
+{
+    points.clear();
+
+    int size = qMin(xData.size(), yData.size());
+    if (size == 0 || maxBuckets <= 0 || m_levels.isEmpty()) {
+        return;
+    }
+
+    // Pick the finest level that fits the requested number of buckets
+    int level = 0;
+    qint64 bucketSize = BASE_BUCKET_SIZE;
+    while (level < m_levels.size() - 1 && (m_count - m_dropped) / bucketSize > maxBuckets) {
+        level++;
+        bucketSize <<= 1;
+    }
+
+    const Level &l  = m_levels.at(level);
+    qint64 start    = m_dropped;
+    qint64 end      = m_dropped + size;
+    qint64 lodStart = qBound(start, l.first * bucketSize, end);
+    qint64 lodEnd   = qBound(lodStart, lodStart + l.min.size() * bucketSize, end);
+
+    points.reserve((lodStart - start) + 2 * l.min.size() + (end - lodEnd));
+
+    // Samples before the first complete bucket are drawn as they are...
+    for (qint64 i = start; i < lodStart; i++) {
+        points.append(QPointF(xData.at(i - m_dropped), yData.at(i - m_dropped)));
+    }
+
+    // ...the complete buckets as a vertical min/max segment...
+    int bucket = 0;
+    for (qint64 i = lodStart; i < lodEnd; i += bucketSize, bucket++) {
+        double x = xData.at(i - m_dropped);
+        points.append(QPointF(x, l.min.at(bucket)));
+        points.append(QPointF(x, l.max.at(bucket)));
+    }
+
+    // ...and so is the tail that has not filled a bucket yet
+    for (qint64 i = lodEnd; i < end; i++) {
+        points.append(QPointF(xData.at(i - m_dropped), yData.at(i - m_dropped)));
+    }
+}
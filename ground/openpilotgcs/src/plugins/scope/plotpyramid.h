@@ -0,0 +1,83 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotpyramid.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTPYRAMID_H
+#define PLOTPYRAMID_H
+
+#include "plotbuffer.h"
+
+#include <QPointF>
+#include <QVector>
+
+/*!
+   \brief Min/max level of detail pyramid kept alongside the y samples of a curve.
+
+   Level L holds the minimum and maximum of consecutive, aligned buckets of
+   (BASE_BUCKET_SIZE << L) samples. A bucket is only stored once it is complete
+   and all its samples are still in the plot window, and a completed bucket is
+   merged into its parent level, so appending costs O(1) amortized.
+ */
+class PlotPyramid {
+public:
+    PlotPyramid();
+
+    void append(double value);
+    void popFront();
+    void clear();
+
+    /*!
+       \brief Builds a min/max envelope of the window with at most about
+       \a maxBuckets buckets, each contributing a min and a max point.
+
+       \a xData and \a yData must be the buffers that were fed to this pyramid.
+     */
+    void decimate(const PlotBuffer &xData, const PlotBuffer &yData, int maxBuckets, QVector<QPointF> &points) const;
+
+private:
+    static const int BASE_BUCKET_SIZE = 4;
+    static const int MAX_LEVELS = 24;
+
+    struct Level {
+        Level() : first(0), pendingCount(0), pendingMin(0), pendingMax(0) {}
+
+        PlotBuffer min;
+        PlotBuffer max;
+        qint64 first; // Index of the oldest stored bucket
+        int pendingCount; // Children merged into the incomplete bucket
+        double pendingMin;
+        double pendingMax;
+    };
+
+    void merge(int level, double min, double max);
+    void trim(Level &level, qint64 bucketSize);
+
+    QVector<Level> m_levels;
+    qint64 m_count; // Samples appended since the last clear
+    qint64 m_dropped; // Samples removed from the front since the last clear
+};
+
+#endif // PLOTPYRAMID_H
@@ -4,7 +4,9 @@ DEFINES += SCOPE_LIBRARY
 include(../../openpilotgcsplugin.pri)
 include (scope_dependencies.pri)
 HEADERS += scopeplugin.h \
+    plotbuffer.h \
     plotdata.h \
+    plotpyramid.h \
     scope_global.h
 HEADERS += scopegadgetoptionspage.h
 HEADERS += scopegadgetconfiguration.h
@@ -12,7 +14,8 @@ HEADERS += scopegadget.h
 HEADERS += scopegadgetwidget.h
 HEADERS += scopegadgetfactory.h
 SOURCES += scopeplugin.cpp \
-    plotdata.cpp
+    plotdata.cpp \
+    plotpyramid.cpp
 SOURCES += scopegadgetoptionspage.cpp
 SOURCES += scopegadgetconfiguration.cpp
 SOURCES += scopegadget.cpp
@@ -412,7 +412,7 @@ void ScopeGadgetWidget::addCurvePlot(QString uavObject, QString uavFieldSubField
     plotData->m_xWindowSize = m_xWindowSize;
     plotData->scalePower    = scaleOrderFactor;
     plotData->meanSamples   = meanSamples;
-    plotData->mathFunction  = mathFunction;
+    plotData->setMathFunction(mathFunction);
 
     // If the y-bounds are supplied, set them
     if (plotData->yMinimum != plotData->yMaximum) {
@@ -431,14 +431,15 @@ void ScopeGadgetWidget::addCurvePlot(QString uavObject, QString uavFieldSubField
     UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject((plotData->uavObject)));
     if (!obj) {
         qDebug() << "Object " << plotData->uavObject << " is missing";
+        delete plotData;
         return;
     }
-    UAVObjectField *field = obj->getField(plotData->uavField);
-    if (!field) {
+    if (!plotData->bind(obj)) {
         qDebug() << "In scope gadget, in fields loaded from GCS config file, field" << plotData->uavField << " of object " << plotData->uavObject << " is missing";
+        delete plotData;
         return;
     }
-    QString units = field->getUnits();
+    QString units = obj->getField(plotData->uavField)->getUnits();
 
     if (units == 0) {
         units = QString();
@@ -458,12 +459,16 @@ void ScopeGadgetWidget::addCurvePlot(QString uavObject, QString uavFieldSubField
     }
 
     plotCurve->setPen(pen);
-    plotCurve->setSamples(*plotData->xData, *plotData->yData);
-    plotCurve->attach(this);
     plotData->curve = plotCurve;
+    plotData->updatePlotCurveData();
+    plotCurve->attach(this);
 
-    // Keep the curve details for later
+    // Keep the curve details for later, replacing a curve with the same name
+    if (m_curvesData.contains(curveNameScaled)) {
+        deleteCurve(m_curvesData.value(curveNameScaled));
+    }
     m_curvesData.insert(curveNameScaled, plotData);
+    m_curvesByObject[obj].append(plotData);
 
     // Link to the new signal data only if this UAVObject has not been connected yet
     if (!m_connectedUAVObjects.contains(obj->getName())) {
@@ -494,7 +499,8 @@ void ScopeGadgetWidget::addCurvePlot(QString uavObject, QString uavFieldSubField
 
 void ScopeGadgetWidget::uavObjectReceived(UAVObject *obj)
 {
-    foreach(PlotData * plotData, m_curvesData.values()) {
+    // Only the curves plotting this object need to see the update
+    foreach(PlotData * plotData, m_curvesByObject.value(obj)) {
         if (plotData->append(obj)) {
             m_csvLoggingDataUpdated = 1;
         }
@@ -511,7 +517,7 @@ void ScopeGadgetWidget::replotNewData()
     QMutexLocker locker(&mutex);
     foreach(PlotData * plotData, m_curvesData.values()) {
         plotData->removeStaleData();
-        plotData->curve->setSamples(*plotData->xData, *plotData->yData);
+        plotData->updatePlotCurveData(canvas()->width());
     }
 
     QDateTime NOW = QDateTime::currentDateTime();
@@ -528,6 +534,25 @@ void ScopeGadgetWidget::replotNewData()
     replot();
 }
 
+/**
+ * Detach and delete a curve, also dropping it from the per object lookup.
+ */
+void ScopeGadgetWidget::deleteCurve(PlotData *plotData)
+{
+    QMutableHashIterator<UAVObject *, QList<PlotData *> > i(m_curvesByObject);
+    while (i.hasNext()) {
+        i.next();
+        i.value().removeAll(plotData);
+        if (i.value().isEmpty()) {
+            i.remove();
+        }
+    }
+
+    plotData->curve->detach();
+    delete plotData->curve;
+    delete plotData;
+}
+
 void ScopeGadgetWidget::clearCurvePlots()
 {
     foreach(PlotData * plotData, m_curvesData.values()) {
@@ -538,6 +563,7 @@ void ScopeGadgetWidget::clearCurvePlots()
     }
 
     m_curvesData.clear();
+    m_curvesByObject.clear();
 }
 
 
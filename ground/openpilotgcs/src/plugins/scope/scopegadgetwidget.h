@@ -40,6 +40,7 @@
 #include <QTime>
 #include <QVector>
 #include <QMutex>
+#include <QHash>
 
 /*!
    \brief This class is used to render the time values on the horizontal axis for the
@@ -132,6 +133,7 @@ private:
 
     void preparePlot(PlotType plotType);
     void setupExamplePlot();
+    void deleteCurve(PlotData *plotData);
 
     PlotType m_plotType;
 
@@ -139,6 +141,7 @@ private:
     int m_refreshInterval;
     QList<QString> m_connectedUAVObjects;
     QMap<QString, PlotData *> m_curvesData;
+    QHash<UAVObject *, QList<PlotData *> > m_curvesByObject;
 
     QTimer *replotTimer;
 
@@ -47,10 +47,9 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
 
 
     m_renderer = new QSvgRenderer();
-    background = new QGraphicsSvgItem();
-    foreground = new QGraphicsSvgItem();
-    nolink     = new QGraphicsSvgItem();
-    missingElements = new QStringList();
+    background = new CachedSvgItem();
+    foreground = new CachedSvgItem();
+    nolink     = new CachedSvgItem();
     paint();
 
     // Now connect the widget to the SystemAlarms UAVObject
@@ -86,53 +85,52 @@ void SystemHealthGadgetWidget::onAutopilotDisconnect()
 
 void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
 {
-    // This code does not know anything about alarms beforehand, and
-    // I found no efficient way to locate items inside the scene by
-    // name, so it's just as simple to reset the scene:
-    // And add the one with the right name.
-    QGraphicsScene *m_scene = scene();
-
-    foreach(QGraphicsItem * item, background->childItems()) {
-        m_scene->removeItem(item);
-        delete item; // removeItem does _not_ delete the item.
-    }
-
-    QString alarm = systemAlarm->getName();
+    // The alarm positions are known since the system file was loaded,
+    // each alarm keeps its indicator item and only swaps its element
+    // when the alarm level changed.
     foreach(UAVObjectField * field, systemAlarm->getFields()) {
         for (uint i = 0; i < field->getNumElements(); ++i) {
             QString element = field->getElementNames()[i];
-            QString value   = field->getValue(i).toString();
-            if (!missingElements->contains(element)) {
-                if (m_renderer->elementExists(element)) {
-                    QMatrix blockMatrix = m_renderer->matrixForElement(element);
-                    qreal startX = blockMatrix.mapRect(m_renderer->boundsOnElement(element)).x();
-                    qreal startY = blockMatrix.mapRect(m_renderer->boundsOnElement(element)).y();
-                    QString element2    = element + "-" + value;
-                    if (!missingElements->contains(element2)) {
-                        if (m_renderer->elementExists(element2)) {
-                            QGraphicsSvgItem *ind = new QGraphicsSvgItem();
-                            ind->setSharedRenderer(m_renderer);
-                            ind->setElementId(element2);
-                            ind->setParentItem(background);
-                            QTransform matrix;
-                            matrix.translate(startX, startY);
-                            ind->setTransform(matrix, false);
-                        } else {
-                            if (value.compare("Uninitialised") != 0) {
-                                missingElements->append(element2);
-                                qDebug() << "Warning: element " << element2 << " not found in SVG.";
-                            }
-                        }
-                    }
-                } else {
-                    missingElements->append(element);
-                    qDebug() << "Warning: Element " << element << " not found in SVG.";
+            if (!alarmPositions.contains(element)) {
+                continue;
+            }
+            QString element2   = element + "-" + field->getValue(i).toString();
+            CachedSvgItem *ind = indicators.value(element, 0);
+            if (!hasElement(element2)) {
+                if (ind) {
+                    ind->setVisible(false);
                 }
+                continue;
             }
+            if (!ind) {
+                ind = new CachedSvgItem();
+                ind->setSharedRenderer(m_renderer);
+                ind->setParentItem(background);
+                QTransform matrix;
+                matrix.translate(alarmPositions.value(element).x(), alarmPositions.value(element).y());
+                ind->setTransform(matrix, false);
+                indicators.insert(element, ind);
+            }
+            if (ind->elementId() != element2) {
+                ind->setElementId(element2);
+            }
+            ind->setVisible(true);
         }
     }
 }
 
+bool SystemHealthGadgetWidget::hasElement(const QString &elementId)
+{
+    QHash<QString, bool>::const_iterator i = knownElements.constFind(elementId);
+
+    if (i != knownElements.constEnd()) {
+        return i.value();
+    }
+    bool exists = m_renderer->elementExists(elementId);
+    knownElements.insert(elementId, exists);
+    return exists;
+}
+
 SystemHealthGadgetWidget::~SystemHealthGadgetWidget()
 {
     // Do nothing
@@ -141,8 +139,11 @@ SystemHealthGadgetWidget::~SystemHealthGadgetWidget()
 
 void SystemHealthGadgetWidget::setSystemFile(QString dfn)
 {
-    // Clear the list of elements not found on svg
-    missingElements->clear();
+    // Forget everything looked up in the previous file
+    qDeleteAll(indicators);
+    indicators.clear();
+    alarmPositions.clear();
+    knownElements.clear();
     setBackgroundBrush(QBrush(Utils::StyleHelper::baseColor()));
     if (QFile::exists(dfn)) {
         m_renderer->load(dfn);
@@ -167,13 +168,32 @@ void SystemHealthGadgetWidget::setSystemFile(QString dfn)
             l_scene->setSceneRect(background->boundingRect());
             fitInView(background, Qt::KeepAspectRatio);
 
-            // Check whether the autopilot is connected already, by the way:
             ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
             UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
             TelemetryManager *telMngr    = pm->getObject<TelemetryManager>();
+            SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
+
+            // Locate every alarm and check which of its levels the file has
+            foreach(UAVObjectField * field, obj->getFields()) {
+                foreach(QString element, field->getElementNames()) {
+                    if (!m_renderer->elementExists(element)) {
+                        qDebug() << "Warning: Element " << element << " not found in SVG.";
+                        continue;
+                    }
+                    QMatrix blockMatrix = m_renderer->matrixForElement(element);
+                    alarmPositions.insert(element, blockMatrix.mapRect(m_renderer->boundsOnElement(element)).topLeft());
+                    foreach(QString option, field->getOptions()) {
+                        QString element2 = element + "-" + option;
+                        if (!hasElement(element2) && option.compare("Uninitialised") != 0) {
+                            qDebug() << "Warning: element " << element2 << " not found in SVG.";
+                        }
+                    }
+                }
+            }
+
+            // Check whether the autopilot is connected already, by the way:
             if (telMngr->isConnected()) {
                 onAutopilotConnect();
-                SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
                 updateAlarms(obj);
             }
         }
@@ -220,7 +240,7 @@ void SystemHealthGadgetWidget::mousePressEvent(QMouseEvent *event)
         foreach(QGraphicsItem * sceneItem, items(point)) {
             QGraphicsSvgItem *clickedItem = dynamic_cast<QGraphicsSvgItem *>(sceneItem);
 
-            if (clickedItem) {
+            if (clickedItem && clickedItem->isVisible()) {
                 if ((clickedItem != foreground) && (clickedItem != background)) {
                     // Clicked an actual alarm. We need to set haveAlarmItem to true
                     // as two of the items in this loop will always be foreground and
@@ -265,7 +285,8 @@ void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint & location)
         foreach(QGraphicsItem * curItem, graphicsScene->items()) {
             QGraphicsSvgItem *curSvgItem = dynamic_cast<QGraphicsSvgItem *>(curItem);
 
-            if (curSvgItem && (curSvgItem != foreground) && (curSvgItem != background)) {
+            if (curSvgItem && curSvgItem->isVisible() &&
+                (curSvgItem != foreground) && (curSvgItem != background)) {
                 QString elementId = curSvgItem->elementId();
                 if (!elementId.contains("OK")) {
                     // Found an alarm, get its corresponding alarm html file contents
@@ -34,10 +34,12 @@
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
+#include <utils/cachedsvgitem.h>
 #include <QMouseEvent>
 
 #include <QFile>
 #include <QTimer>
+#include <QHash>
 
 class SystemHealthGadgetWidget : public QGraphicsView {
     Q_OBJECT
@@ -61,13 +63,18 @@ private slots:
 
 private:
     QSvgRenderer *m_renderer;
-    QGraphicsSvgItem *background;
-    QGraphicsSvgItem *foreground;
-    QGraphicsSvgItem *nolink;
-    QStringList *missingElements;
+    CachedSvgItem *background;
+    CachedSvgItem *foreground;
+    CachedSvgItem *nolink;
+    // Looked up once per system file instead of on every alarm update
+    QHash<QString, QPointF> alarmPositions;
+    QHash<QString, bool> knownElements;
+    // One indicator per alarm, kept across updates
+    QHash<QString, CachedSvgItem *> indicators;
     // Simple flag to skip rendering if the
     bool fgenabled; // layer does not exist.
 
+    bool hasElement(const QString &elementId);
     void showAlarmDescriptionForItemId(const QString itemId, const QPoint & location);
     void showAllAlarmDescriptions(const QPoint &location);
 };
@@ -49,6 +49,8 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
     m_browser->setupUi(this);
     m_model = new UAVObjectTreeModel();
     m_browser->treeView->setModel(m_model);
+    connect(m_browser->treeView, SIGNAL(expanded(QModelIndex)), m_model, SLOT(itemExpanded(QModelIndex)));
+    connect(m_browser->treeView, SIGNAL(collapsed(QModelIndex)), m_model, SLOT(itemCollapsed(QModelIndex)));
     m_browser->treeView->setColumnWidth(0, 300);
     // m_browser->treeView->expandAll();
     BrowserItemDelegate *m_delegate = new BrowserItemDelegate();
@@ -107,6 +109,8 @@ void UAVObjectBrowserWidget::categorize(bool categorize)
     m_model->setRecentlyUpdatedTimeout(m_recentlyUpdatedTimeout);
     m_model->setOnlyHilightChangedValues(m_onlyHilightChangedValues);
     m_browser->treeView->setModel(m_model);
+    connect(m_browser->treeView, SIGNAL(expanded(QModelIndex)), m_model, SLOT(itemExpanded(QModelIndex)));
+    connect(m_browser->treeView, SIGNAL(collapsed(QModelIndex)), m_model, SLOT(itemCollapsed(QModelIndex)));
     showMetaData(m_viewoptions->cbMetaData->isChecked());
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
 
@@ -127,6 +131,8 @@ void UAVObjectBrowserWidget::useScientificNotation(bool scientific)
     m_model->setManuallyChangedColor(m_manuallyChangedColor);
     m_model->setRecentlyUpdatedTimeout(m_recentlyUpdatedTimeout);
     m_browser->treeView->setModel(m_model);
+    connect(m_browser->treeView, SIGNAL(expanded(QModelIndex)), m_model, SLOT(itemExpanded(QModelIndex)));
+    connect(m_browser->treeView, SIGNAL(collapsed(QModelIndex)), m_model, SLOT(itemCollapsed(QModelIndex)));
     showMetaData(m_viewoptions->cbMetaData->isChecked());
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
 
@@ -138,6 +144,7 @@ void UAVObjectBrowserWidget::sendUpdate()
     this->setFocus();
     ObjectTreeItem *objItem = findCurrentObjectTreeItem();
     Q_ASSERT(objItem);
+    m_model->refreshObject(objItem);
     objItem->apply();
     UAVObject *obj = objItem->object();
     Q_ASSERT(obj);
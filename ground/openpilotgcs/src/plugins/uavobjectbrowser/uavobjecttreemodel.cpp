@@ -36,6 +36,10 @@
 #include <QtCore/QTimer>
 #include <QtCore/QSignalMapper>
 #include <QtCore/QDebug>
+#include <QtAlgorithms>
+
+// Updates are flushed at most this often (ms), about one display frame
+static const int UPDATE_INTERVAL = 16;
 
 UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool useScientificNotation) :
     QAbstractItemModel(parent),
@@ -55,6 +59,10 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool us
 
     TreeItem::setHighlightTime(m_recentlyUpdatedTimeout);
     setupModelData(objManager);
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(UPDATE_INTERVAL);
+    connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(flushUpdates()));
 }
 
 UAVObjectTreeModel::~UAVObjectTreeModel()
@@ -159,17 +167,17 @@ MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeIt
         }
     }
     parent->appendChild(meta);
+    m_objectTreeItems.insert(obj, meta);
     return meta;
 }
 
 void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
     connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
-    TreeItem *item;
+    ObjectTreeItem *item;
     if (obj->isSingleInstance()) {
-        item = parent;
-        DataObjectTreeItem *p = static_cast<DataObjectTreeItem *>(parent);
-        p->setObject(obj);
+        item = static_cast<DataObjectTreeItem *>(parent);
+        item->setObject(obj);
     } else {
         QString name = tr("Instance") + " " + QString::number(obj->getInstID());
         item = new InstanceTreeItem(obj, name);
@@ -177,6 +185,7 @@ void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
         connect(item, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
         parent->appendChild(item);
     }
+    m_objectTreeItems.insert(obj, item);
     foreach(UAVObjectField * field, obj->getFields()) {
         if (field->getNumElements() > 1) {
             addArrayField(field, item);
@@ -276,17 +285,7 @@ QModelIndex UAVObjectTreeModel::index(TreeItem *item)
         return QModelIndex();
     }
 
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem *>(childIndex.internalPointer());
-        if (child == item) {
-            return childIndex;
-        }
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
+    return createIndex(item->row(), 0, item);
 }
 
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
@@ -429,56 +428,119 @@ QVariant UAVObjectTreeModel::headerData(int section, Qt::Orientation orientation
     return QVariant();
 }
 
+/**
+ * Only marks the object, the tree is updated by flushUpdates() so that
+ * a burst of updates costs one refresh per display frame.
+ */
 void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
-    ObjectTreeItem *item = findObjectTreeItem(obj);
+    ObjectTreeItem *item = m_objectTreeItems.value(obj);
     Q_ASSERT(item);
-    if (!m_onlyHilightChangedValues) {
-        item->setHighlight(true);
-    }
-    item->update();
-    if (!m_onlyHilightChangedValues) {
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+    if (item) {
+        m_updatedObjects.insert(item);
+        scheduleUpdate();
     }
 }
 
-ObjectTreeItem *UAVObjectTreeModel::findObjectTreeItem(UAVObject *object)
+void UAVObjectTreeModel::updateHighlight(TreeItem *item)
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(object);
-    UAVMetaObject *metaObject = qobject_cast<UAVMetaObject *>(object);
+    m_changedItems.insert(item);
+    scheduleUpdate();
+}
 
-    Q_ASSERT(dataObject || metaObject);
-    if (dataObject) {
-        return findDataObjectTreeItem(dataObject);
-    } else {
-        return findMetaObjectTreeItem(metaObject);
+void UAVObjectTreeModel::scheduleUpdate()
+{
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
     }
-    return 0;
 }
 
-DataObjectTreeItem *UAVObjectTreeModel::findDataObjectTreeItem(UAVDataObject *obj)
+/**
+ * True if the children of the item are shown, that is the item
+ * and all of its parents are expanded.
+ */
+bool UAVObjectTreeModel::isShown(TreeItem *item) const
 {
-    TopTreeItem *root = obj->isSettings() ? m_settingsTree : m_nonSettingsTree;
+    for (; item && item != m_rootItem; item = item->parent()) {
+        if (!m_expandedItems.contains(item)) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    return root->findDataObjectTreeItemByObjectId(obj->getObjID());
+void UAVObjectTreeModel::itemExpanded(const QModelIndex &index)
+{
+    m_expandedItems.insert(static_cast<TreeItem *>(index.internalPointer()));
+
+    // Catch up on the objects that became visible
+    QMutableSetIterator<ObjectTreeItem *> iter(m_staleObjects);
+    while (iter.hasNext()) {
+        ObjectTreeItem *item = iter.next();
+        if (isShown(item)) {
+            item->update();
+            iter.remove();
+        }
+    }
 }
 
-MetaObjectTreeItem *UAVObjectTreeModel::findMetaObjectTreeItem(UAVMetaObject *obj)
+void UAVObjectTreeModel::itemCollapsed(const QModelIndex &index)
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(obj->getParentObject());
+    m_expandedItems.remove(static_cast<TreeItem *>(index.internalPointer()));
+}
 
-    Q_ASSERT(dataObject);
-    TopTreeItem *root = dataObject->isSettings() ? m_settingsTree : m_nonSettingsTree;
-    return root->findMetaObjectTreeItemByObjectId(obj->getObjID());
+/**
+ * The fields of collapsed objects, and of objects updated since the last
+ * display frame, may still hold older values than the object. Refresh them
+ * now, as apply() writes every field back to the object.
+ */
+void UAVObjectTreeModel::refreshObject(ObjectTreeItem *item)
+{
+    if (m_staleObjects.remove(item) || m_updatedObjects.contains(item)) {
+        item->update();
+    }
 }
 
-void UAVObjectTreeModel::updateHighlight(TreeItem *item)
+void UAVObjectTreeModel::flushUpdates()
 {
-    QModelIndex itemIndex = index(item);
+    QSet<ObjectTreeItem *> updated;
 
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::dataColumn));
+    updated.swap(m_updatedObjects);
+    foreach(ObjectTreeItem * item, updated) {
+        if (!m_onlyHilightChangedValues) {
+            item->setHighlight(true);
+            m_changedItems.insert(item);
+        }
+        // The fields of collapsed objects are refreshed when they are expanded
+        if (isShown(item)) {
+            item->update();
+        } else {
+            m_staleObjects.insert(item);
+        }
+    }
+
+    // Group the changed rows by parent and notify each contiguous block once
+    QHash<TreeItem *, QList<int> > changedRows;
+    foreach(TreeItem * item, m_changedItems) {
+        if (item->parent()) {
+            changedRows[item->parent()].append(item->row());
+        }
+    }
+    m_changedItems.clear();
+
+    QHash<TreeItem *, QList<int> >::iterator i;
+    for (i = changedRows.begin(); i != changedRows.end(); ++i) {
+        QModelIndex parentIndex = index(i.key());
+        QList<int> &rows = i.value();
+        qSort(rows);
+        int first = 0;
+        for (int n = 1; n <= rows.size(); ++n) {
+            if (n == rows.size() || rows.at(n) != rows.at(n - 1) + 1) {
+                emit dataChanged(index(rows.at(first), 0, parentIndex),
+                                 index(rows.at(n - 1), TreeItem::dataColumn, parentIndex));
+                first = n;
+            }
+        }
+    }
 }
@@ -32,6 +32,9 @@
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
 #include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
 #include <QColor>
 
 class TopTreeItem;
@@ -43,7 +46,6 @@ class UAVMetaObject;
 class UAVObjectField;
 class UAVObjectManager;
 class QSignalMapper;
-class QTimer;
 
 class UAVObjectTreeModel : public QAbstractItemModel {
     Q_OBJECT
@@ -81,15 +83,21 @@ public:
     }
 
     QList<QModelIndex> getMetaDataIndexes();
+    // Bring the fields of an object up to date before they are applied to it
+    void refreshObject(ObjectTreeItem *item);
 
 signals:
 
 public slots:
     void newObject(UAVObject *obj);
+    // Keep track of the rows shown by the view, collapsed objects are not refreshed
+    void itemExpanded(const QModelIndex &index);
+    void itemCollapsed(const QModelIndex &index);
 
 private slots:
     void highlightUpdatedObject(UAVObject *obj);
     void updateHighlight(TreeItem *);
+    void flushUpdates();
 
 private:
     void setupModelData(UAVObjectManager *objManager);
@@ -103,9 +111,8 @@ private:
     TreeItem *createCategoryItems(QStringList categoryPath, TreeItem *root);
 
     QString updateMode(quint8 updateMode);
-    ObjectTreeItem *findObjectTreeItem(UAVObject *obj);
-    DataObjectTreeItem *findDataObjectTreeItem(UAVDataObject *obj);
-    MetaObjectTreeItem *findMetaObjectTreeItem(UAVMetaObject *obj);
+    bool isShown(TreeItem *item) const;
+    void scheduleUpdate();
 
     TreeItem *m_rootItem;
     TopTreeItem *m_settingsTree;
@@ -119,6 +126,15 @@ private:
 
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
+
+    // Object updates are collected and applied once per display frame
+    QHash<UAVObject *, ObjectTreeItem *> m_objectTreeItems;
+    QSet<ObjectTreeItem *> m_updatedObjects;
+    QSet<TreeItem *> m_changedItems;
+    // Objects updated while their fields were not shown
+    QSet<ObjectTreeItem *> m_staleObjects;
+    QSet<TreeItem *> m_expandedItems;
+    QTimer m_updateTimer;
 };
 
 #endif // UAVOBJECTTREEMODEL_H
@@ -0,0 +1,18 @@
+# -------------------------------------------------
+# UAVObjects lookup and field access micro benchmarks,
+# run with -tickcounter or -callgrind
+# for stable numbers
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = uavobjectsbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../openpilotgcs.pri)
+include(../../uavobjects.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot -L$$GCS_LIBRARY_PATH
+
+SOURCES += uavobjectsbenchmark.cpp
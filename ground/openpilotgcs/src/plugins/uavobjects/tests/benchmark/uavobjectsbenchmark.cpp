@@ -0,0 +1,214 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsbenchmark.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Micro benchmarks for the UAVObjects plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "attitudestate.h"
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+class tst_UAVObjectsBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void lookupById();
+    void lookupByIdLinear();
+    void lookupByName();
+    void lookupByNameLinear();
+
+    void fieldReadVariant();
+    void fieldReadTyped();
+    void fieldReadSnapshot();
+
+private:
+    UAVObjectManager *objMngr;
+    AttitudeState *attitude;
+    QList<quint32> objIds;
+    QList<QString> objNames;
+
+    UAVObject *linearLookup(const QList< QList<UAVObject *> > &objects, const QString *name, quint32 objId, quint32 instId);
+};
+
+void tst_UAVObjectsBenchmark::initTestCase()
+{
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+
+    QList< QList<UAVObject *> > objects = objMngr->getObjects();
+    foreach(QList<UAVObject *> instances, objects) {
+        objIds.append(instances[0]->getObjID());
+        objNames.append(instances[0]->getName());
+    }
+    QVERIFY(!objIds.isEmpty());
+
+    attitude = AttitudeState::GetInstance(objMngr);
+    QVERIFY(attitude != NULL);
+    AttitudeState::DataFields data = attitude->getData();
+    data.q1    = 1.0f;
+    data.Roll  = 12.5f;
+    data.Pitch = -3.25f;
+    data.Yaw   = 270.0f;
+    attitude->setData(data);
+}
+
+void tst_UAVObjectsBenchmark::cleanupTestCase()
+{
+    delete objMngr;
+}
+
+/**
+ * The lookup as it was done before the manager had its indexes,
+ * used as the reference for the indexed lookups.
+ */
+UAVObject *tst_UAVObjectsBenchmark::linearLookup(const QList< QList<UAVObject *> > &objects, const QString *name, quint32 objId, quint32 instId)
+{
+    for (int objidx = 0; objidx < objects.length(); ++objidx) {
+        if (objects[objidx].length() > 0) {
+            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
+                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
+                    if (objects[objidx][instidx]->getInstID() == instId) {
+                        return objects[objidx][instidx];
+                    }
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+void tst_UAVObjectsBenchmark::lookupById()
+{
+    UAVObject *obj = NULL;
+
+    QBENCHMARK {
+        foreach(quint32 objId, objIds) {
+            obj = objMngr->getObject(objId);
+        }
+    }
+    QVERIFY(obj != NULL);
+}
+
+void tst_UAVObjectsBenchmark::lookupByIdLinear()
+{
+    QList< QList<UAVObject *> > objects = objMngr->getObjects();
+    UAVObject *obj = NULL;
+
+    QBENCHMARK {
+        foreach(quint32 objId, objIds) {
+            obj = linearLookup(objects, NULL, objId, 0);
+        }
+    }
+    QCOMPARE(obj, objMngr->getObject(objIds.last()));
+}
+
+void tst_UAVObjectsBenchmark::lookupByName()
+{
+    UAVObject *obj = NULL;
+
+    QBENCHMARK {
+        foreach(const QString &name, objNames) {
+            obj = objMngr->getObject(name);
+        }
+    }
+    QVERIFY(obj != NULL);
+}
+
+void tst_UAVObjectsBenchmark::lookupByNameLinear()
+{
+    QList< QList<UAVObject *> > objects = objMngr->getObjects();
+    UAVObject *obj = NULL;
+
+    QBENCHMARK {
+        foreach(const QString &name, objNames) {
+            obj = linearLookup(objects, &name, 0, 0);
+        }
+    }
+    QCOMPARE(obj, objMngr->getObject(objNames.last()));
+}
+
+/**
+ * Reads every field of AttitudeState the way the gadgets used to,
+ * through getValue() and a QVariant.
+ */
+void tst_UAVObjectsBenchmark::fieldReadVariant()
+{
+    QList<UAVObjectField *> fields = attitude->getFields();
+    float sum = 0;
+
+    QBENCHMARK {
+        sum = 0;
+        foreach(UAVObjectField * field, fields) {
+            sum += field->getValue().toFloat();
+        }
+    }
+    QCOMPARE(sum, 1.0f + 12.5f - 3.25f + 270.0f);
+}
+
+void tst_UAVObjectsBenchmark::fieldReadTyped()
+{
+    QList<UAVObjectField *> fields = attitude->getFields();
+    float sum = 0;
+
+    QBENCHMARK {
+        sum = 0;
+        foreach(UAVObjectField * field, fields) {
+            sum += field->get<float>();
+        }
+    }
+    QCOMPARE(sum, 1.0f + 12.5f - 3.25f + 270.0f);
+}
+
+void tst_UAVObjectsBenchmark::fieldReadSnapshot()
+{
+    QList<UAVObjectField *> fields = attitude->getFields();
+    AttitudeState::DataFields data;
+    float sum = 0;
+
+    QBENCHMARK {
+        data = attitude->getData();
+        sum = 0;
+        foreach(UAVObjectField * field, fields) {
+            sum += field->getFromSnapshot<float>(reinterpret_cast<const quint8 *>(&data));
+        }
+    }
+    QCOMPARE(sum, 1.0f + 12.5f - 3.25f + 270.0f);
+    QCOMPARE(data.Yaw, 270.0f);
+}
+
+QTEST_MAIN(tst_UAVObjectsBenchmark)
+
+#include "uavobjectsbenchmark.moc"
+
+/**
+ * @}
+ * @}
+ */
@@ -312,6 +312,23 @@ qint32 UAVObject::pack(quint8 *dataOut)
  * @returns The number of bytes copied
  */
 qint32 UAVObject::unpack(const quint8 *dataIn)
+{
+    QMutexLocker locker(mutex);
+
+    unpackSilently(dataIn);
+    emit objectUnpacked(this); // trigger object updated event
+    emit objectUpdated(this);
+
+    return numBytes;
+}
+
+/**
+ * Unpack the object data from a byte array without signalling the update
+ * (used by the UAVTalk reader thread, the update is signalled when a copy of
+ * the data is unpacked again in the thread of the object)
+ * @returns The number of bytes copied
+ */
+qint32 UAVObject::unpackSilently(const quint8 *dataIn)
 {
     QMutexLocker locker(mutex);
     qint32 offset = 0;
@@ -320,9 +337,6 @@ qint32 UAVObject::unpack(const quint8 *dataIn)
         fields[n]->unpack(&dataIn[offset]);
         offset += fields[n]->getNumBytes();
     }
-    emit objectUnpacked(this); // trigger object updated event
-    emit objectUpdated(this);
-
     return numBytes;
 }
 
@@ -589,6 +589,16 @@ UAVObject *UAVObjectField::getObject()
     return obj;
 }
 
+QMutex *UAVObjectField::objectMutex()
+{
+    return obj->getMutex();
+}
+
+bool UAVObjectField::isGcsWritable()
+{
+    return UAVObject::GetGcsAccess(obj->getMetadata()) == UAVObject::ACCESS_READWRITE;
+}
+
 void UAVObjectField::clear()
 {
     QMutexLocker locker(obj->getMutex());
@@ -1116,6 +1126,58 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
 
 double UAVObjectField::getDouble(quint32 index)
 {
+    QMutexLocker locker(obj->getMutex());
+
+    // Check that index is not out of bounds
+    if (index >= numElements) {
+        return 0.0;
+    }
+    // Read numeric values directly, without going through a QVariant
+    const quint8 *element = &data[offset + numBytesPerElement * index];
+    switch (type) {
+    case INT8:
+    {
+        qint8 tmpint8;
+        memcpy(&tmpint8, element, numBytesPerElement);
+        return tmpint8;
+    }
+    case INT16:
+    {
+        qint16 tmpint16;
+        memcpy(&tmpint16, element, numBytesPerElement);
+        return tmpint16;
+    }
+    case INT32:
+    {
+        qint32 tmpint32;
+        memcpy(&tmpint32, element, numBytesPerElement);
+        return tmpint32;
+    }
+    case UINT8:
+        return *element;
+    case UINT16:
+    {
+        quint16 tmpuint16;
+        memcpy(&tmpuint16, element, numBytesPerElement);
+        return tmpuint16;
+    }
+    case UINT32:
+    {
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, element, numBytesPerElement);
+        return tmpuint32;
+    }
+    case FLOAT32:
+    {
+        float tmpfloat;
+        memcpy(&tmpfloat, element, numBytesPerElement);
+        return tmpfloat;
+    }
+    case BITFIELD:
+        return (data[offset + numBytesPerElement * ((quint32)(index / 8))] >> (index % 8)) & 1;
+    default:
+        break;
+    }
     return getValue(index).toDouble();
 }
 
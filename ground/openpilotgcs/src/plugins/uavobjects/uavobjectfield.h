@@ -34,6 +34,8 @@
 #include <QVariant>
 #include <QList>
 #include <QMap>
+#include <QMutexLocker>
+#include <string.h>
 
 class UAVObject;
 
@@ -67,6 +69,48 @@ public:
     void setValue(const QVariant & data, quint32 index = 0);
     double getDouble(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
+
+    /**
+     * Typed access to a single element, read straight from the object data.
+     * T must be the C type of the field elements: qint8 ... quint32, float,
+     * or quint8 for enums, which returns the option index.
+     * Bitfields and strings are not supported, use getValue() for those.
+     */
+    template <typename T> T get(quint32 index = 0)
+    {
+        QMutexLocker locker(objectMutex());
+
+        return getFromSnapshot<T>(data, index);
+    }
+
+    /**
+     * Same as get(), but reads from a copy of the object data previously
+     * taken with the getData() of the generated object, without locking the object.
+     */
+    template <typename T> T getFromSnapshot(const quint8 *snapshot, quint32 index = 0) const
+    {
+        Q_ASSERT(sizeof(T) == numBytesPerElement && type != BITFIELD && type != STRING);
+        T value = T();
+
+        if (index < numElements) {
+            memcpy(&value, &snapshot[offset + sizeof(T) * index], sizeof(T));
+        }
+        return value;
+    }
+
+    /**
+     * Typed counterpart of setValue(), with the same access mode check.
+     */
+    template <typename T> void set(T value, quint32 index = 0)
+    {
+        Q_ASSERT(sizeof(T) == numBytesPerElement && type != BITFIELD && type != STRING);
+        QMutexLocker locker(objectMutex());
+
+        if (index < numElements && isGcsWritable()) {
+            memcpy(&data[offset + sizeof(T) * index], &value, sizeof(T));
+        }
+    }
+
     quint32 getDataOffset();
     quint32 getNumBytes();
     bool isNumeric();
@@ -94,6 +138,9 @@ protected:
     void clear();
     void constructorInitialize(const QString & name, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
     void limitsInitialize(const QString &limits);
+    // Keep the inline templates independent of the UAVObject definition
+    QMutex *objectMutex();
+    bool isGcsWritable();
 };
 
 #endif // UAVOBJECTFIELD_H
@@ -32,12 +32,12 @@
  */
 UAVObjectManager::UAVObjectManager()
 {
-    mutex = new QMutex(QMutex::Recursive);
+    lock = new QReadWriteLock();
 }
 
 UAVObjectManager::~UAVObjectManager()
 {
-    delete mutex;
+    delete lock;
 }
 
 /**
@@ -48,12 +48,19 @@ UAVObjectManager::~UAVObjectManager()
  */
 bool UAVObjectManager::registerObject(UAVDataObject *obj)
 {
-    QMutexLocker locker(mutex);
+    // Objects and instances added while holding the lock, notifications
+    // are only sent once the lock is released so that the receivers are free
+    // to query the manager.
+    QList<UAVObject *> addedObjects;
+    QList<UAVObject *> addedInstances;
+    UAVObject *refObj = NULL;
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0 && objects[objidx][0]->getObjID() == obj->getObjID()) {
+    {
+        QWriteLocker locker(lock);
+
+        // Check if this object type is already in the list
+        int objidx = findObjectIndex(NULL, obj->getObjID());
+        if (objidx >= 0) {
             // Check if this is a single instance object, if yes we can not add a new instance
             if (obj->isSingleInstance()) {
                 return false;
@@ -61,66 +68,93 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
             // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
             // There is a single metaobject for all object instances of this type, so no need to create a new one
             // Get object type metaobject from existing instance
-            UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
-            if (refObj == NULL) {
+            QList<UAVObject *> &instances = objects[objidx];
+            UAVDataObject *refDataObj     = dynamic_cast<UAVDataObject *>(instances[0]);
+            if (refDataObj == NULL) {
                 return false;
             }
-            UAVMetaObject *mobj = refObj->getMetaObject();
+            refObj = refDataObj;
+            UAVMetaObject *mobj = refDataObj->getMetaObject();
             // If the instance ID is specified and not at the default value (0) then we need to make sure
             // that there are no gaps in the instance list. If gaps are found then then additional instances
             // will be created.
             if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
-                        // Instance conflict, do not add
-                        return false;
-                    }
+                // Instance IDs are contiguous, any ID below the instance count is a conflict
+                if (obj->getInstID() < (quint32)instances.length()) {
+                    return false;
                 }
                 // Check if there are any gaps between the requested instance ID and the ones in the list,
                 // if any then create the missing instances.
-                for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
+                for (quint32 instidx = instances.length(); instidx < obj->getInstID(); ++instidx) {
                     UAVDataObject *cobj = obj->clone(instidx);
+                    // Instances may be registered by a telemetry reader thread, keep them all in one thread
+                    cobj->moveToThread(obj->thread());
                     cobj->initialize(mobj);
-                    objects[objidx].append(cobj);
-                    getObject(cobj->getObjID())->emitNewInstance(cobj);
-                    emit newInstance(cobj);
+                    instances.append(cobj);
+                    addedInstances.append(cobj);
                 }
                 // Finally, initialize the actual object instance
                 obj->initialize(mobj);
             } else if (obj->getInstID() == 0) {
                 // Assign the next available ID and initialize the object instance
-                obj->initialize(objects[objidx].length(), mobj);
+                obj->initialize(instances.length(), mobj);
             } else {
                 return false;
             }
             // Add the actual object instance in the list
-            objects[objidx].append(obj);
-            getObject(obj->getObjID())->emitNewInstance(obj);
-            emit newInstance(obj);
-            return true;
+            instances.append(obj);
+            addedInstances.append(obj);
+        } else {
+            // If this point is reached then this is the first time this object type (ID) is added in the list
+            // create a new list of the instances, add in the object collection and create the object's metaobject
+            // Create metaobject
+            QString mname = obj->getName();
+            mname.append("Meta");
+            UAVMetaObject *mobj = new UAVMetaObject(obj->getObjID() + 1, mname, obj);
+            // Initialize object
+            obj->initialize(0, mobj);
+            // Add to list
+            addObject(obj);
+            addObject(mobj);
+            addedObjects.append(obj);
+            addedObjects.append(mobj);
         }
     }
-    // If this point is reached then this is the first time this object type (ID) is added in the list
-    // create a new list of the instances, add in the object collection and create the object's metaobject
-    // Create metaobject
-    QString mname = obj->getName();
-    mname.append("Meta");
-    UAVMetaObject *mobj = new UAVMetaObject(obj->getObjID() + 1, mname, obj);
-    // Initialize object
-    obj->initialize(0, mobj);
-    // Add to list
-    addObject(obj);
-    addObject(mobj);
+
+    foreach(UAVObject * newObj, addedObjects) {
+        emit newObject(newObj);
+    }
+    foreach(UAVObject * newInst, addedInstances) {
+        refObj->emitNewInstance(newInst);
+        emit newInstance(newInst);
+    }
     return true;
 }
 
+/**
+ * Add a new object type to the list and index it, the lock must be held for writing.
+ */
 void UAVObjectManager::addObject(UAVObject *obj)
 {
     // Add to list
     QList<UAVObject *> list;
     list.append(obj);
     objects.append(list);
-    emit newObject(obj);
+    objectIdIndex.insert(obj->getObjID(), objects.length() - 1);
+    objectNameIndex.insert(obj->getName(), objects.length() - 1);
+}
+
+/**
+ * Find the position of an object type in the objects list given its name or,
+ * if name is NULL, its object ID. The lock must be held by the caller.
+ * @returns The index in the objects list or -1 if the object type is not registered
+ */
+int UAVObjectManager::findObjectIndex(const QString *name, quint32 objId) const
+{
+    if (name != NULL) {
+        return objectNameIndex.value(*name, -1);
+    }
+    return objectIdIndex.value(objId, -1);
 }
 
 /**
@@ -129,7 +163,7 @@ void UAVObjectManager::addObject(UAVObject *obj)
  */
 QList< QList<UAVObject *> > UAVObjectManager::getObjects()
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(lock);
 
     return objects;
 }
@@ -139,7 +173,7 @@ QList< QList<UAVObject *> > UAVObjectManager::getObjects()
  */
 QList< QList<UAVDataObject *> > UAVObjectManager::getDataObjects()
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(lock);
 
     QList< QList<UAVDataObject *> > dObjects;
 
@@ -172,7 +206,7 @@ QList< QList<UAVDataObject *> > UAVObjectManager::getDataObjects()
  */
 QList <QList<UAVMetaObject *> > UAVObjectManager::getMetaObjects()
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(lock);
 
     QList< QList<UAVMetaObject *> > mObjects;
 
@@ -223,20 +257,15 @@ UAVObject *UAVObjectManager::getObject(quint32 objId, quint32 instId)
  */
 UAVObject *UAVObjectManager::getObject(const QString *name, quint32 objId, quint32 instId)
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(lock);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == instId) {
-                        return objects[objidx][instidx];
-                    }
-                }
-            }
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        // Instance IDs are contiguous, so the instance ID is also the list position
+        const QList<UAVObject *> &instances = objects.at(objidx);
+        if (instId < (quint32)instances.length()) {
+            return instances.at(instId);
         }
     }
     // qWarning("UAVObjectManager::getObject: Object not found.  Probably a bug or mismatched GCS/flight versions.");
@@ -265,16 +294,12 @@ QList<UAVObject *> UAVObjectManager::getObjectInstances(quint32 objId)
  */
 QList<UAVObject *> UAVObjectManager::getObjectInstances(const QString *name, quint32 objId)
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(lock);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx];
-            }
-        }
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        return objects.at(objidx);
     }
     // If this point is reached then the requested object could not be found
     return QList<UAVObject *>();
@@ -301,16 +326,12 @@ qint32 UAVObjectManager::getNumInstances(quint32 objId)
  */
 qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(lock);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx].length();
-            }
-        }
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        return objects.at(objidx).length();
     }
     // If this point is reached then the requested object could not be found
     return -1;
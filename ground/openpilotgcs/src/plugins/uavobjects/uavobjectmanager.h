@@ -33,8 +33,8 @@
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
 #include <QList>
-#include <QMutex>
-#include <QMutexLocker>
+#include <QHash>
+#include <QReadWriteLock>
 
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
     Q_OBJECT
@@ -61,10 +61,16 @@ signals:
 private:
     static const quint32 MAX_INSTANCES = 1000;
 
+    // Object instances grouped by type, instance IDs within a type are contiguous
+    // so that the instance list can be indexed directly by instance ID
     QList< QList<UAVObject *> > objects;
-    QMutex *mutex;
+    // Index of each object type in the objects list, by object ID and by name
+    QHash<quint32, int> objectIdIndex;
+    QHash<QString, int> objectNameIndex;
+    QReadWriteLock *lock;
 
     void addObject(UAVObject *obj);
+    int findObjectIndex(const QString *name, quint32 objId) const;
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
     QList<UAVObject *> getObjectInstances(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
@@ -294,29 +294,22 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
 void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
 {
     // Initiate transaction
-    bool sent = false;
-
     if (transInfo->objRequest) {
 #ifdef VERBOSE_TELEMETRY
         qDebug().nospace() << "Telemetry - sending request for object " << transInfo->obj->toStringBrief() << ", " << (transInfo->allInstances ? "all" : "single") << " " << (transInfo->acked ? "acked" : "");
 #endif
-        sent = utalk->sendObjectRequest(transInfo->obj, transInfo->allInstances);
+        utalk->sendObjectRequest(transInfo->obj, transInfo->allInstances);
     } else {
 #ifdef VERBOSE_TELEMETRY
         qDebug().nospace() << "Telemetry - sending object " << transInfo->obj->toStringBrief() << ", " << (transInfo->allInstances ? "all" : "single") << " " << (transInfo->acked ? "acked" : "");
 #endif
-        sent = utalk->sendObject(transInfo->obj, transInfo->acked, transInfo->allInstances);
+        utalk->sendObject(transInfo->obj, transInfo->acked, transInfo->allInstances);
     }
     // Check if a response is needed now or will arrive asynchronously
     if (transInfo->objRequest || transInfo->acked) {
-        if (sent) {
-            // Start timer if a response is expected
-            transInfo->timer->start(REQ_TIMEOUT_MS);
-        } else {
-            // message was not sent, the transaction will not complete and will timeout
-            // there is no need to wait to close the transaction and notify of completion failure
-            // transactionCompleted(transInfo->obj, false);
-        }
+        // Start timer if a response is expected, a message that was not sent is
+        // retried on timeout like a lost one, so every transaction completes
+        transInfo->timer->start(REQ_TIMEOUT_MS);
     } else {
         // not transacted, so just close the transaction with no notification of completion
         closeTransaction(transInfo);
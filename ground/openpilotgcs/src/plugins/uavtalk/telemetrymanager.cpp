@@ -29,6 +29,7 @@
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/threadmanager.h>
+#include <coreplugin/generalsettings.h>
 
 TelemetryManager::TelemetryManager() : autopilotConnected(false)
 {
@@ -59,20 +60,23 @@ void TelemetryManager::start(QIODevice *dev)
 void TelemetryManager::onStart()
 {
     utalk = new UAVTalk(device, objMngr);
-    if (false) {
-        // UAVTalk must be thread safe and for that:
-        // 1- all public methods must lock a mutex
-        // 2- the reader thread must lock that mutex too
-        // The reader thread locks the mutex once a packet is read and decoded.
-        // It is assumed that the UAVObjectManager is thread safe
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+    if (settings && settings->useThreadedTelemetry()) {
+        // The stream is decoded by the reader thread, the thread of the device only
+        // reads and writes it, as the serial, network and USB devices are not thread
+        // safe. The reader unpacks the objects and completes the transactions, only
+        // the object updates are signalled to the GUI thread, in batches.
+        utalk->setThreadedInput(true);
 
         // Create the reader and move it to the reader thread
         IODeviceReader *reader = new IODeviceReader(utalk);
         reader->moveToThread(&readerThread);
         // The reader will be deleted (later) when the thread finishes
         connect(&readerThread, &QThread::finished, reader, &QObject::deleteLater);
-        // Connect IO device to reader
-        connect(device, SIGNAL(readyRead()), reader, SLOT(read()));
+        // Connect the bytes read from the IO device to reader
+        connect(utalk, SIGNAL(inputQueued()), reader, SLOT(read()));
         // start the reader thread
         readerThread.start();
     } else {
@@ -82,6 +86,9 @@ void TelemetryManager::onStart()
 
     telemetry    = new Telemetry(utalk, objMngr);
     telemetryMon = new TelemetryMonitor(objMngr, telemetry);
+    if (settings) {
+        telemetryMon->setRetrievalWindow(settings->telemetryRetrievalWindow());
+    }
 
     connect(telemetryMon, SIGNAL(connected()), this, SLOT(onConnect()));
     connect(telemetryMon, SIGNAL(disconnected()), this, SLOT(onDisconnect()));
@@ -91,15 +98,15 @@ void TelemetryManager::onStart()
 void TelemetryManager::stop()
 {
     emit myStop();
-
-    if (false) {
-        readerThread.quit();
-        readerThread.wait();
-    }
 }
 
 void TelemetryManager::onStop()
 {
+    // The reader must be done with UAVTalk before it is deleted
+    if (readerThread.isRunning()) {
+        readerThread.quit();
+        readerThread.wait();
+    }
     telemetryMon->disconnect(this);
     delete telemetryMon;
     delete telemetry;
@@ -72,7 +72,7 @@ private:
 };
 
 
-class IODeviceReader : public QObject {
+class UAVTALK_EXPORT IODeviceReader : public QObject {
     Q_OBJECT
 public:
     IODeviceReader(UAVTalk *uavTalk);
@@ -39,10 +39,15 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel) :
     flightStatsObj(FlightTelemetryStats::GetInstance(objMngr)),
     firmwareIAPObj(FirmwareIAPObj::GetInstance(objMngr)),
     statsTimer(new QTimer(this)),
-    objPending(NULL),
     mutex(new QMutex(QMutex::Recursive)),
-    connectionTimer(new QTime())
+    connectionTimer(new QTime()),
+    retrievalWindow(DEFAULT_RETRIEVAL_WINDOW),
+    retrieving(false),
+    unreportedRetries(0),
+    unreportedFailures(0)
 {
+    memset(&retrievalStats, 0, sizeof(retrievalStats));
+
     // Listen for flight stats updates
     connect(flightStatsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(flightStatsUpdated(UAVObject *)));
 
@@ -61,6 +66,26 @@ TelemetryMonitor::~TelemetryMonitor()
     gcsStatsObj->setData(gcsStats);
 }
 
+/**
+ * Set how many objects can be requested at once while retrieving them on connection.
+ */
+void TelemetryMonitor::setRetrievalWindow(int size)
+{
+    QMutexLocker locker(mutex);
+
+    retrievalWindow = qMax(size, 1);
+}
+
+int TelemetryMonitor::getRetrievalWindow() const
+{
+    return retrievalWindow;
+}
+
+TelemetryMonitor::ObjectRetrievalStats TelemetryMonitor::getObjectRetrievalStats() const
+{
+    return retrievalStats;
+}
+
 /**
  * Initiate object retrieval, initialize queue with objects to be retrieved.
  */
@@ -68,6 +93,7 @@ void TelemetryMonitor::startRetrievingObjects()
 {
     // Clear object queue
     queue.clear();
+    objRetries.clear();
     // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue
     QList< QList<UAVObject *> > objs = objMngr->getObjects();
     for (int n = 0; n < objs.length(); ++n) {
@@ -87,9 +113,13 @@ void TelemetryMonitor::startRetrievingObjects()
             }
         }
     }
+    memset(&retrievalStats, 0, sizeof(retrievalStats));
+    retrievalStats.objects = queue.length();
+    retrievalStart.start();
+    retrieving = true;
     // Start retrieving
-    qDebug() << tr("Starting to retrieve meta and settings objects from the autopilot (%1 objects)")
-        .arg(queue.length());
+    qDebug() << tr("Starting to retrieve meta and settings objects from the autopilot (%1 objects, %2 at once)")
+        .arg(queue.length()).arg(retrievalWindow);
     retrieveNextObject();
 }
 
@@ -100,34 +130,79 @@ void TelemetryMonitor::stopRetrievingObjects()
 {
     qDebug("Object retrieval has been cancelled");
     queue.clear();
+    foreach(UAVObject * obj, objsPending) {
+        obj->disconnect(this);
+    }
+    objsPending.clear();
+    objRetries.clear();
+    retrieving = false;
 }
 
 /**
- * Retrieve the next object in the queue
+ * Request objects from the queue until the retrieval window is full
  */
 void TelemetryMonitor::retrieveNextObject()
 {
-    // If queue is empty return
-    if (queue.isEmpty()) {
-        qDebug("Object retrieval completed");
+    // A request can complete before requestUpdate() returns and get here again,
+    // retrieving is only set until the retrieval is over
+    while (!queue.isEmpty() && objsPending.size() < retrievalWindow) {
+        requestObject(queue.dequeue());
+    }
+
+    // Done once the queue is empty and all the requests have been answered
+    if (queue.isEmpty() && objsPending.isEmpty() && retrieving) {
+        retrieving = false;
+        retrievalStats.durationMs = retrievalStart.elapsed();
+        qDebug() << tr("Object retrieval completed in %1 ms (%2 objects, %3 retries, %4 failed)")
+            .arg(retrievalStats.durationMs).arg(retrievalStats.objects)
+            .arg(retrievalStats.retries).arg(retrievalStats.failures);
         if (firmwareIAPObj->getBoardType()) {
             emit connected();
         } else {
             connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
         }
-        return;
     }
+}
 
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
+/**
+ * Send the update request for an object and keep track of it until it completes
+ */
+void TelemetryMonitor::requestObject(UAVObject *obj)
+{
     // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
 
     // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)), Qt::UniqueConnection);
+
+    objsPending.insert(obj);
 
-    // Request update
+    // Request update, Telemetry completes the transaction once it was answered,
+    // or failed after its own retries
     obj->requestUpdate();
-    objPending = obj;
+}
+
+/**
+ * Retire a pending request, queueing the object again if it failed and can be retried
+ */
+void TelemetryMonitor::objectRequestDone(UAVObject *obj, bool success)
+{
+    // Disconnect from sending object
+    obj->disconnect(this);
+    objsPending.remove(obj);
+
+    if (!success) {
+        int retries = objRetries.value(obj, 0);
+        if (retries < RETRIEVAL_MAX_RETRIES) {
+            objRetries.insert(obj, retries + 1);
+            ++retrievalStats.retries;
+            ++unreportedRetries;
+            queue.enqueue(obj);
+        } else {
+            ++retrievalStats.failures;
+            ++unreportedFailures;
+            qWarning() << tr("Failed to retrieve object %1").arg(obj->getName());
+        }
+    }
 }
 
 /**
@@ -135,13 +210,10 @@ void TelemetryMonitor::retrieveNextObject()
  */
 void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
 {
-    Q_UNUSED(success);
     QMutexLocker locker(mutex);
 
-    if (obj == objPending) {
-        // Disconnect from sending object
-        obj->disconnect(this);
-        objPending = NULL;
+    if (objsPending.contains(obj)) {
+        objectRequestDone(obj, success);
         // Process next object if telemetry is still available
         GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
 
@@ -201,8 +273,12 @@ void TelemetryMonitor::processStatsUpdates()
     // Update stats object
     gcsStats.TxDataRate    = (float)telStats.txBytes / ((float)statsTimer->interval() / 1000.0);
     gcsStats.TxBytes      += telStats.txBytes;
-    gcsStats.TxFailures   += telStats.txErrors;
-    gcsStats.TxRetries    += telStats.txRetries;
+    gcsStats.TxFailures   += telStats.txErrors + unreportedFailures;
+    gcsStats.TxRetries    += telStats.txRetries + unreportedRetries;
+
+    // Object retrieval counts towards the transmit statistics
+    unreportedRetries      = 0;
+    unreportedFailures     = 0;
 
     gcsStats.RxDataRate    = (float)telStats.rxBytes / ((float)statsTimer->interval() / 1000.0);
     gcsStats.RxBytes      += telStats.rxBytes;
@@ -30,6 +30,8 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QHash>
+#include <QSet>
 #include <QTimer>
 #include <QTime>
 #include <QMutex>
@@ -45,9 +47,23 @@ class TelemetryMonitor : public QObject {
     Q_OBJECT
 
 public:
+    /**
+     * Statistics of the last object retrieval done on connection
+     */
+    typedef struct {
+        int objects; // Objects queued for retrieval
+        int retries; // Requests sent again after a failure or a timeout
+        int failures; // Objects given up on
+        int durationMs; // Time from connection to the end of the retrieval
+    } ObjectRetrievalStats;
+
     TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel);
     ~TelemetryMonitor();
 
+    void setRetrievalWindow(int size);
+    int getRetrievalWindow() const;
+    ObjectRetrievalStats getObjectRetrievalStats() const;
+
 signals:
     void connected();
     void disconnected();
@@ -63,6 +79,10 @@ private:
     static const int STATS_UPDATE_PERIOD_MS  = 4000;
     static const int STATS_CONNECT_PERIOD_MS = 2000;
     static const int CONNECTION_TIMEOUT_MS   = 8000;
+    // Objects requested at once while retrieving, 1 waits for each object in turn
+    static const int DEFAULT_RETRIEVAL_WINDOW = 8;
+    // Requests sent again once Telemetry reported them as failed
+    static const int RETRIEVAL_MAX_RETRIES    = 2;
 
     UAVObjectManager *objMngr;
     Telemetry *tel;
@@ -71,12 +91,22 @@ private:
     FlightTelemetryStats *flightStatsObj;
     FirmwareIAPObj *firmwareIAPObj;
     QTimer *statsTimer;
-    UAVObject *objPending;
     QMutex *mutex;
     QTime *connectionTimer;
+    QSet<UAVObject *> objsPending; // Requested objects, until Telemetry completes their transaction
+    QHash<UAVObject *, int> objRetries;
+    int retrievalWindow;
+    bool retrieving;
+    QTime retrievalStart;
+    ObjectRetrievalStats retrievalStats;
+    // Retrieval retries and failures not yet added to the GCS telemetry stats
+    quint32 unreportedRetries;
+    quint32 unreportedFailures;
 
     void startRetrievingObjects();
     void retrieveNextObject();
+    void requestObject(UAVObject *obj);
+    void objectRequestDone(UAVObject *obj, bool success);
     void stopRetrievingObjects();
 };
 
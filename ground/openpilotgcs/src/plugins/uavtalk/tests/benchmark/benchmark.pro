@@ -0,0 +1,17 @@
+# -------------------------------------------------
+# UAVTalk receiver benchmark, set OPL_BENCHMARK_LOG to the
+# .opl log file to replay
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = uavtalkbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../openpilotgcs.pri)
+include(../../uavtalk.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot -L$$GCS_LIBRARY_PATH
+
+SOURCES += uavtalkbenchmark.cpp
@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkbenchmark.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Throughput benchmark for the UAVTalk receiver
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalk.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QFile>
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QtTest>
+
+/**
+ * Sequential device handing out the replayed stream in chunks of a fixed size,
+ * a chunk size of one byte reproduces the byte by byte receive path.
+ */
+class ChunkedStreamDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    ChunkedStreamDevice(const QByteArray &stream, qint64 chunkSize) : stream(stream), chunkSize(chunkSize), pos(0)
+    {}
+
+    bool isSequential() const
+    {
+        return true;
+    }
+
+    qint64 bytesAvailable() const
+    {
+        return stream.size() - pos + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize)
+    {
+        qint64 length = qMin(qMin(maxSize, chunkSize), (qint64)stream.size() - pos);
+
+        memcpy(data, stream.constData() + pos, length);
+        pos += length;
+        return length;
+    }
+
+    qint64 writeData(const char *data, qint64 maxSize)
+    {
+        Q_UNUSED(data);
+        return maxSize;
+    }
+
+private:
+    QByteArray stream;
+    qint64 chunkSize;
+    qint64 pos;
+};
+
+class tst_UAVTalkBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void receive_data();
+    void receive();
+
+private:
+    UAVObjectManager *objMngr;
+    QByteArray stream;
+};
+
+void tst_UAVTalkBenchmark::initTestCase()
+{
+    objMngr = NULL;
+
+    QString fileName = qgetenv("OPL_BENCHMARK_LOG");
+
+    if (fileName.isEmpty()) {
+        QSKIP("OPL_BENCHMARK_LOG is not set");
+    }
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    // Strip the log record headers (timestamp and size) to get the raw telemetry stream
+    quint32 timeStamp;
+    qint64 dataSize;
+    while (file.read((char *)&timeStamp, sizeof(timeStamp)) == sizeof(timeStamp) &&
+           file.read((char *)&dataSize, sizeof(dataSize)) == sizeof(dataSize)) {
+        if (dataSize < 1 || dataSize > (1024 * 1024)) {
+            break;
+        }
+        stream.append(file.read(dataSize));
+    }
+    QVERIFY(!stream.isEmpty());
+
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+}
+
+void tst_UAVTalkBenchmark::cleanupTestCase()
+{
+    delete objMngr;
+}
+
+void tst_UAVTalkBenchmark::receive_data()
+{
+    QTest::addColumn<qint64>("chunkSize");
+
+    QTest::newRow("bytewise") << (qint64)1;
+    QTest::newRow("hid report") << (qint64)64;
+    QTest::newRow("bulk") << (qint64)stream.size();
+}
+
+void tst_UAVTalkBenchmark::receive()
+{
+    QFETCH(qint64, chunkSize);
+
+    ChunkedStreamDevice device(stream, chunkSize);
+    QVERIFY(device.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    UAVTalk talk(&device, objMngr);
+    QElapsedTimer timer;
+    timer.start();
+    while (device.bytesAvailable() > 0) {
+        QMetaObject::invokeMethod(&talk, "processInputStream", Qt::DirectConnection);
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+
+    UAVTalk::ComStats stats = talk.getStats();
+    QCOMPARE((qint64)stats.rxBytes, (qint64)stream.size());
+    QVERIFY(stats.rxObjects > 0);
+
+    QTest::setBenchmarkResult((qreal)stream.size() * 1e9 / qMax(elapsed, (qint64)1), QTest::BytesPerSecond);
+    qDebug() << "Received" << stats.rxObjects << "objects," << stats.rxErrors << "errors at"
+             << (stream.size() / 1e6) / (qMax(elapsed, (qint64)1) / 1e9) << "MB/s";
+}
+
+QTEST_MAIN(tst_UAVTalkBenchmark)
+
+#include "uavtalkbenchmark.moc"
+
+/**
+ * @}
+ * @}
+ */
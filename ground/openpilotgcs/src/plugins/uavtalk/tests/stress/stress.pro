@@ -0,0 +1,17 @@
+# -------------------------------------------------
+# UAVTalk reader thread stress test, replays a high rate
+# telemetry stream while the GUI thread is blocked
+# -------------------------------------------------
+QT -= gui
+QT += testlib network
+TARGET = uavtalkstress
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../openpilotgcs.pri)
+include(../../uavtalk.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot -L$$GCS_LIBRARY_PATH
+
+SOURCES += uavtalkstress.cpp
@@ -0,0 +1,296 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkstress.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Stress test for the UAVTalk reader thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalk.h"
+#include "telemetrymanager.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QBuffer>
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QElapsedTimer>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtTest/QtTest>
+
+static const int UPDATE_COUNT = 20000;
+
+/**
+ * Local TCP connection whose sockets live in the link thread, like a serial
+ * or USB device that keeps delivering data while the GUI thread is busy.
+ * UAVTalk reads and writes the device end, the test feeds the other end.
+ */
+class Link : public QObject {
+    Q_OBJECT
+
+public:
+    Link() : device(NULL), server(NULL), peer(NULL)
+    {}
+
+    QTcpSocket *device;
+
+public slots:
+    void open()
+    {
+        server = new QTcpServer(this);
+        server->listen(QHostAddress::LocalHost);
+        device = new QTcpSocket(this);
+        device->connectToHost(QHostAddress::LocalHost, server->serverPort());
+        server->waitForNewConnection(5000);
+        peer   = server->nextPendingConnection();
+        device->waitForConnected(5000);
+    }
+
+    void feed(const QByteArray &stream, int chunkSize)
+    {
+        for (int pos = 0; pos < stream.size(); pos += chunkSize) {
+            peer->write(stream.mid(pos, chunkSize));
+            peer->flush();
+        }
+    }
+
+    void close()
+    {
+        delete device;
+        delete server;
+        device = NULL;
+        server = NULL;
+        peer   = NULL;
+    }
+
+private:
+    QTcpServer *server;
+    QTcpSocket *peer;
+};
+
+class tst_UAVTalkStress : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void blockedGui_data();
+    void blockedGui();
+    void transactionWithBlockedGui();
+
+    void objectUpdated(UAVObject *obj);
+    void transactionCompleted(UAVObject *obj, bool success);
+
+private:
+    UAVObjectManager *objMngr;
+    UAVObject *obj;
+    QByteArray stream;
+    QByteArray response;
+    QList<double> values;
+    bool wrongThread;
+
+    // written by the reader thread
+    QMutex transactionMutex;
+    bool completed;
+    bool completedSuccess;
+    QThread *completedThread;
+};
+
+void tst_UAVTalkStress::initTestCase()
+{
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+    obj     = objMngr->getObject("AttitudeState");
+    QVERIFY(obj != NULL);
+
+    // Encode the updates with a second set of objects, as the flight side would
+    UAVObjectManager sendMngr;
+    UAVObjectsInitialize(&sendMngr);
+    UAVObject *sendObj = sendMngr.getObject("AttitudeState");
+    QVERIFY(sendObj != NULL);
+
+    QBuffer buffer(&stream);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    UAVTalk sender(&buffer, &sendMngr);
+    for (int i = 0; i < UPDATE_COUNT; ++i) {
+        sendObj->getField("Roll")->setDouble(i);
+        QVERIFY(sender.sendObject(sendObj, false, false));
+    }
+    QCOMPARE((int)sender.getStats().txObjects, UPDATE_COUNT);
+
+    // The answer to an object request
+    QBuffer responseBuffer(&response);
+    QVERIFY(responseBuffer.open(QIODevice::WriteOnly));
+    UAVTalk responder(&responseBuffer, &sendMngr);
+    sendObj->getField("Roll")->setDouble(-1);
+    QVERIFY(responder.sendObject(sendObj, false, false));
+
+    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+}
+
+void tst_UAVTalkStress::cleanupTestCase()
+{
+    delete objMngr;
+}
+
+void tst_UAVTalkStress::objectUpdated(UAVObject *obj)
+{
+    wrongThread |= (QThread::currentThread() != thread());
+    values.append(obj->getField("Roll")->getDouble());
+}
+
+void tst_UAVTalkStress::transactionCompleted(UAVObject *obj, bool success)
+{
+    QMutexLocker locker(&transactionMutex);
+
+    completed |= (obj == this->obj);
+    completedSuccess = success;
+    completedThread  = QThread::currentThread();
+}
+
+void tst_UAVTalkStress::blockedGui_data()
+{
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("hid report") << 64;
+    QTest::newRow("bulk") << 4096;
+}
+
+void tst_UAVTalkStress::blockedGui()
+{
+    QFETCH(int, chunkSize);
+
+    values.clear();
+    wrongThread = false;
+
+    QThread linkThread;
+    Link link;
+    link.moveToThread(&linkThread);
+    linkThread.start();
+    QMetaObject::invokeMethod(&link, "open", Qt::BlockingQueuedConnection);
+    QVERIFY(link.device && link.device->state() == QAbstractSocket::ConnectedState);
+
+    UAVTalk *talk = new UAVTalk(link.device, objMngr);
+    talk->setThreadedInput(true);
+
+    QThread readerThread;
+    IODeviceReader reader(talk);
+    reader.moveToThread(&readerThread);
+    connect(talk, SIGNAL(inputQueued()), &reader, SLOT(read()));
+    readerThread.start();
+
+    QMetaObject::invokeMethod(&link, "feed", Qt::QueuedConnection, Q_ARG(QByteArray, stream), Q_ARG(int, chunkSize));
+
+    // Keep the GUI thread busy without processing events, the link and reader threads have to keep up on their own
+    QElapsedTimer timer;
+    timer.start();
+    while (talk->getStats().rxObjects < (quint32)UPDATE_COUNT && timer.elapsed() < 30000) {
+        QThread::msleep(10);
+    }
+    QCOMPARE((int)talk->getStats().rxObjects, UPDATE_COUNT);
+    QVERIFY(values.isEmpty());
+    // The reader thread unpacked the data already
+    QCOMPARE(obj->getField("Roll")->getDouble(), (double)(UPDATE_COUNT - 1));
+
+    // Once the GUI thread runs again every update is signalled there, in order,
+    // with its own data
+    QTRY_COMPARE(values.size(), UPDATE_COUNT);
+    QVERIFY(!wrongThread);
+    for (int i = 0; i < values.size(); ++i) {
+        QCOMPARE(values.at(i), (double)i);
+    }
+    QCOMPARE(obj->getField("Roll")->getDouble(), (double)(UPDATE_COUNT - 1));
+
+    UAVTalk::ComStats stats = talk->getStats();
+    QCOMPARE((int)stats.rxErrors, 0);
+    QCOMPARE((qint64)stats.rxBytes, (qint64)stream.size());
+
+    readerThread.quit();
+    readerThread.wait();
+    delete talk;
+    QMetaObject::invokeMethod(&link, "close", Qt::BlockingQueuedConnection);
+    linkThread.quit();
+    linkThread.wait();
+}
+
+void tst_UAVTalkStress::transactionWithBlockedGui()
+{
+    completed = false;
+    completedSuccess = false;
+    completedThread  = NULL;
+
+    QThread linkThread;
+    Link link;
+    link.moveToThread(&linkThread);
+    linkThread.start();
+    QMetaObject::invokeMethod(&link, "open", Qt::BlockingQueuedConnection);
+    QVERIFY(link.device && link.device->state() == QAbstractSocket::ConnectedState);
+
+    UAVTalk *talk = new UAVTalk(link.device, objMngr);
+    talk->setThreadedInput(true);
+    connect(talk, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)), Qt::DirectConnection);
+
+    QThread readerThread;
+    IODeviceReader reader(talk);
+    reader.moveToThread(&readerThread);
+    connect(talk, SIGNAL(inputQueued()), &reader, SLOT(read()));
+    readerThread.start();
+
+    // The request is written by the link thread
+    QVERIFY(talk->sendObjectRequest(obj, false));
+    QMetaObject::invokeMethod(&link, "feed", Qt::QueuedConnection, Q_ARG(QByteArray, response), Q_ARG(int, response.size()));
+
+    // The GUI thread does not process events, the request has to complete regardless
+    QElapsedTimer timer;
+    timer.start();
+    bool done = false;
+    while (!done && timer.elapsed() < 10000) {
+        QThread::msleep(10);
+        QMutexLocker locker(&transactionMutex);
+        done = completed;
+    }
+    QVERIFY(done);
+    QVERIFY(completedSuccess);
+    QVERIFY(completedThread == &readerThread);
+    QCOMPARE(obj->getField("Roll")->getDouble(), -1.0);
+    QCOMPARE((int)talk->getStats().txObjects, 1);
+
+    readerThread.quit();
+    readerThread.wait();
+    delete talk;
+    QMetaObject::invokeMethod(&link, "close", Qt::BlockingQueuedConnection);
+    linkThread.quit();
+    linkThread.wait();
+}
+
+QTEST_MAIN(tst_UAVTalkStress)
+
+#include "uavtalkstress.moc"
+
+/**
+ * @}
+ * @}
+ */
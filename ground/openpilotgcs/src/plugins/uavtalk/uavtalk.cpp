@@ -42,23 +42,22 @@
 #define VERBOSE_FILTER(objId)
 #endif
 
-#define SYNC_VAL 0x3C
-
 using namespace Utils;
 
 /**
  * Constructor
  */
-UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive)
+UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive), dispatcher(NULL), device(NULL)
 {
     rxState = STATE_SYNC;
     rxPacketLength = 0;
 
     memset(&stats, 0, sizeof(ComStats));
 
+    // The settings are not available when running outside of the GCS (e.g. benchmarks)
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
-    useUDPMirror = settings->useUDPMirror();
+    Core::Internal::GeneralSettings *settings = pm ? pm->getObject<Core::Internal::GeneralSettings>() : NULL;
+    useUDPMirror = settings ? settings->useUDPMirror() : false;
     qDebug() << "USE UDP:::::::::::." << useUDPMirror;
     if (useUDPMirror) {
         udpSocketTx = new QUdpSocket(this);
@@ -76,6 +75,51 @@ UAVTalk::~UAVTalk()
     // disconnect(io, SIGNAL(readyRead()), worker, SLOT(processInputStream()));
 
     closeAllTransactions();
+
+    setThreadedInput(false);
+}
+
+/**
+ * Select the threads that process the input stream. By default processInputStream()
+ * is connected to the readyRead() signal of the device, reads it and decodes the
+ * packets, and the senders write the device directly.
+ *
+ * With threaded input the device is only read and written in its own thread,
+ * inputQueued() tells when processInputStream() has bytes to decode, and the reader
+ * thread that calls it unpacks the objects and completes the transactions. The
+ * object updates are signalled in the thread the objects live in, a batch at a time.
+ */
+void UAVTalk::setThreadedInput(bool threaded)
+{
+    QMutexLocker locker(&mutex);
+
+    if (threaded && !dispatcher) {
+        dispatcher = new UAVTalkDispatcher();
+        dispatcher->moveToThread(objMngr->thread());
+        if (io) {
+            device = new UAVTalkDevice(io);
+            device->moveToThread(io->thread());
+            connect(device, SIGNAL(inputQueued()), this, SIGNAL(inputQueued()), Qt::DirectConnection);
+            connect(io, SIGNAL(readyRead()), device, SLOT(read()));
+            connect(io, SIGNAL(bytesWritten(qint64)), device, SLOT(outputWritten()));
+            // pick up whatever arrived before
+            QMetaObject::invokeMethod(device, "read", Qt::QueuedConnection);
+        }
+    } else if (!threaded && dispatcher) {
+        // updates already received are still signalled
+        dispatcher->flush();
+        dispatcher->deleteLater();
+        dispatcher = NULL;
+        if (device) {
+            // the output queued so far is still written
+            if (io) {
+                io->disconnect(device);
+            }
+            device->disconnect(this);
+            device->deleteLater();
+            device = NULL;
+        }
+    }
 }
 
 /**
@@ -208,32 +252,191 @@ bool UAVTalk::objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVO
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
-    if (io && io->isReadable()) {
+    if (device) {
+        // the device was read in its own thread
+        QByteArray input = device->takeInput();
+        if (!input.isEmpty()) {
+            QMutexLocker locker(&mutex);
+            processInputBuffer((const quint8 *)input.constData(), input.size());
+        }
+        if (dispatcher) {
+            dispatcher->flush();
+        }
+    } else if (io && io->isReadable()) {
         while (io->bytesAvailable() > 0) {
-            int ret = io->read((char *)&tmp, 1);
-            if (ret != -1) {
-                processInputByte(tmp);
-            } else {
-                // TODOD
+            qint64 length = io->read((char *)rxStreamBuffer, RX_STREAM_BUFFER_SIZE);
+            if (length <= 0) {
+                break;
             }
-            if (rxState == STATE_COMPLETE) {
-                mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
-                    stats.rxObjectBytes += rxLength;
-                    stats.rxObjects++;
-                } else {
-                    // TODO...
-                }
-                mutex.unlock();
+            // Locked once per read, the receive state and stats are shared with the senders
+            QMutexLocker locker(&mutex);
+            processInputBuffer(rxStreamBuffer, length);
+        }
+        if (dispatcher) {
+            dispatcher->flush();
+        }
+    }
+}
 
-                if (useUDPMirror) {
-                    // it is safe to do this outside of the above critical section as the rxDataArray is
-                    // accessed from this thread only
-                    udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
-                }
+/**
+ * Process a buffer of bytes from the telemetry stream.
+ * Complete packets are framed in place, the byte by byte state machine is only
+ * used for packets that are split across reads or that fail validation.
+ * \param[in] buffer Received bytes
+ * \param[in] length Number of bytes in buffer
+ */
+void UAVTalk::processInputBuffer(const quint8 *buffer, qint64 length)
+{
+    qint64 pos = 0;
+
+    while (pos < length) {
+        if (rxState != STATE_SYNC && rxState != STATE_COMPLETE && rxState != STATE_ERROR) {
+            // A packet is in progress, let the state machine finish it
+            processInputByte(buffer[pos++]);
+            if (rxState == STATE_COMPLETE) {
+                processReceivedObject();
             }
+            continue;
+        }
+
+        // Skip to the next sync byte
+        const quint8 *sync = (const quint8 *)memchr(buffer + pos, SYNC_VAL, length - pos);
+        qint64 syncPos     = (sync != NULL) ? (sync - buffer) : length;
+        stats.rxBytes      += syncPos - pos;
+        stats.rxSyncErrors += syncPos - pos;
+        pos = syncPos;
+        if (pos >= length) {
+            break;
+        }
+
+        qint32 packetLength = processInputPacket(buffer + pos, length - pos);
+        if (packetLength > 0) {
+            pos += packetLength;
+            processReceivedObject();
+        } else {
+            // Incomplete or invalid packet, start the state machine on the sync byte
+            processInputByte(buffer[pos++]);
+        }
+    }
+}
+
+/**
+ * Frame a complete packet starting with a sync byte.
+ * \param[in] buffer Received bytes, buffer[0] is a sync byte
+ * \param[in] length Number of bytes in buffer
+ * \return The packet length including the checksum, 0 if the buffer does
+ * not hold a complete and valid packet
+ */
+qint32 UAVTalk::processInputPacket(const quint8 *buffer, qint64 length)
+{
+    if (length < HEADER_LENGTH) {
+        return 0;
+    }
+
+    quint8 type = buffer[1];
+    if ((type & TYPE_MASK) != TYPE_VER) {
+        return 0;
+    }
+
+    qint32 size = qFromLittleEndian<quint16>(&buffer[2]);
+    if (size < HEADER_LENGTH || size > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+        return 0;
+    }
+    if (length < size + CHECKSUM_LENGTH) {
+        return 0;
+    }
+
+    quint32 objId  = qFromLittleEndian<quint32>(&buffer[4]);
+    quint16 instId = qFromLittleEndian<quint16>(&buffer[8]);
+
+    // Check the payload length against the object
+    UAVObject *obj = objMngr->getObject(objId);
+    if (obj == NULL && type != TYPE_OBJ_REQ) {
+        return 0;
+    }
+    qint32 dataLength;
+    if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+        dataLength = 0;
+    } else if (obj) {
+        dataLength = obj->getNumBytes();
+    } else {
+        dataLength = size - HEADER_LENGTH;
+    }
+    if (dataLength >= MAX_PAYLOAD_LENGTH || HEADER_LENGTH + dataLength != size) {
+        return 0;
+    }
+
+    // Checksum over the whole header and payload
+    if (Crc::updateCRC(0, buffer, size) != buffer[size]) {
+        return 0;
+    }
+
+    rxType   = type;
+    rxObjId  = objId;
+    rxInstId = instId;
+    rxLength = dataLength;
+    memcpy(rxBuffer, &buffer[HEADER_LENGTH], dataLength);
+    rxState  = STATE_COMPLETE;
+
+    stats.rxBytes += size + CHECKSUM_LENGTH;
+
+    if (useUDPMirror) {
+        rxDataArray = QByteArray((const char *)buffer, size + CHECKSUM_LENGTH);
+    }
+
+    return size + CHECKSUM_LENGTH;
+}
+
+/**
+ * Hand over a complete packet once the receiver reached STATE_COMPLETE.
+ * Must be called with the mutex held.
+ */
+void UAVTalk::processReceivedObject()
+{
+    if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
+        stats.rxObjectBytes += rxLength;
+        stats.rxObjects++;
+    } else {
+        // TODO...
+    }
+
+    if (useUDPMirror) {
+        mirrorPacket(rxDataArray, true);
+    }
+}
+
+/**
+ * Copy a packet to the UDP mirror, received packets are sent to the receive
+ * socket and transmitted ones to the transmit socket. With threaded input the
+ * sockets are written in their own thread.
+ * Must be called with the mutex held.
+ */
+void UAVTalk::mirrorPacket(const QByteArray &packet, bool received)
+{
+    if (device) {
+        if (mirrorQueue.isEmpty()) {
+            QMetaObject::invokeMethod(this, "flushMirror", Qt::QueuedConnection);
+        }
+        mirrorQueue.append(qMakePair(received, packet));
+    } else if (received) {
+        udpSocketTx->writeDatagram(packet, QHostAddress::LocalHost, udpSocketRx->localPort());
+    } else {
+        udpSocketRx->writeDatagram(packet, QHostAddress::LocalHost, udpSocketTx->localPort());
+    }
+}
+
+void UAVTalk::flushMirror()
+{
+    QList<QPair<bool, QByteArray> > packets;
+    {
+        QMutexLocker locker(&mutex);
+        packets.swap(mirrorQueue);
+    }
+    for (int i = 0; i < packets.size(); ++i) {
+        if (packets.at(i).first) {
+            udpSocketTx->writeDatagram(packets.at(i).second, QHostAddress::LocalHost, udpSocketRx->localPort());
+        } else {
+            udpSocketRx->writeDatagram(packets.at(i).second, QHostAddress::LocalHost, udpSocketTx->localPort());
         }
     }
 }
@@ -619,17 +822,29 @@ UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
         }
         // Create a new instance, unpack and register
         UAVDataObject *instObj = dataObj->clone(instId);
-        if (!objMngr->registerObject(instObj)) {
-            qWarning() << "UAVTalk - failed to register object " << instObj->toStringBrief();
-            return NULL;
+        // when created by a reader thread, the instance still belongs to the thread of the other instances
+        instObj->moveToThread(dataObj->thread());
+        if (objMngr->registerObject(instObj)) {
+            obj = instObj;
+        } else {
+            // some other thread may have registered the instance in the meantime
+            obj = objMngr->getObject(objId, instId);
+            if (obj == NULL) {
+                qWarning() << "UAVTalk - failed to register object " << instObj->toStringBrief();
+                delete instObj;
+                return NULL;
+            }
+            delete instObj;
         }
-        instObj->unpack(data);
-        return instObj;
+    }
+    // Unpack data into object instance, the object is locked while it is updated
+    if (dispatcher) {
+        obj->unpackSilently(data);
+        dispatcher->postUpdate(obj, data);
     } else {
-        // Unpack data into object instance
         obj->unpack(data);
-        return obj;
     }
+    return obj;
 }
 
 /**
@@ -786,11 +1001,23 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     txBuffer[HEADER_LENGTH + length] = Crc::updateCRC(0, txBuffer, HEADER_LENGTH + length);
 
     // Send buffer, check that the transmit backlog does not grow above limit
-    if (!io.isNull() && io->isWritable()) {
+    if (device) {
+        // the device thread writes it, and tells when it is not writable
+        if (device->outputBacklog() < TX_BUFFER_SIZE) {
+            device->queueOutput((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
+            if (useUDPMirror) {
+                mirrorPacket(QByteArray((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH), false);
+            }
+        } else {
+            qWarning() << "UAVTalk - error transmitting : io device full";
+            ++stats.txErrors;
+            return false;
+        }
+    } else if (!io.isNull() && io->isWritable()) {
         if (io->bytesToWrite() < TX_BUFFER_SIZE) {
             io->write((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
             if (useUDPMirror) {
-                udpSocketRx->writeDatagram((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
+                mirrorPacket(QByteArray((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH), false);
             }
         } else {
             qWarning() << "UAVTalk - error transmitting : io device full";
@@ -900,3 +1127,130 @@ const char *UAVTalk::typeToString(quint8 type)
     }
     return "<error>";
 }
+
+UAVTalkDevice::UAVTalkDevice(QIODevice *io) : io(io), deviceBacklog(0), writePosted(false)
+{}
+
+/**
+ * Read what the device has received, runs in the thread of the device
+ */
+void UAVTalkDevice::read()
+{
+    if (!io || !io->isReadable()) {
+        return;
+    }
+    QByteArray data = io->readAll();
+    if (data.isEmpty()) {
+        return;
+    }
+
+    bool notify;
+    {
+        QMutexLocker locker(&mutex);
+        // the reader was already told about a queue that is not empty
+        notify = input.isEmpty();
+        input.append(data);
+    }
+    if (notify) {
+        emit inputQueued();
+    }
+}
+
+QByteArray UAVTalkDevice::takeInput()
+{
+    QByteArray data;
+    QMutexLocker locker(&mutex);
+
+    data.swap(input);
+    return data;
+}
+
+void UAVTalkDevice::queueOutput(const char *data, qint64 length)
+{
+    QMutexLocker locker(&mutex);
+
+    output.append(data, length);
+    if (!writePosted) {
+        writePosted = true;
+        QMetaObject::invokeMethod(this, "write", Qt::QueuedConnection);
+    }
+}
+
+qint64 UAVTalkDevice::outputBacklog()
+{
+    QMutexLocker locker(&mutex);
+
+    return output.size() + deviceBacklog;
+}
+
+/**
+ * Write what the senders have queued, runs in the thread of the device
+ */
+void UAVTalkDevice::write()
+{
+    QByteArray data;
+    {
+        QMutexLocker locker(&mutex);
+        data.swap(output);
+        writePosted = false;
+    }
+    if (!io || !io->isWritable()) {
+        qWarning() << "UAVTalk - error transmitting : io device not writable";
+        return;
+    }
+    io->write(data);
+    outputWritten();
+}
+
+void UAVTalkDevice::outputWritten()
+{
+    qint64 backlog = io ? io->bytesToWrite() : 0;
+    QMutexLocker locker(&mutex);
+
+    deviceBacklog = backlog;
+}
+
+UAVTalkDispatcher::UAVTalkDispatcher() : posted(false)
+{}
+
+/**
+ * Queue the update of an object that was unpacked with a copy of its data, it is
+ * signalled by processUpdates()
+ */
+void UAVTalkDispatcher::postUpdate(UAVObject *obj, const quint8 *data)
+{
+    incoming.append(Update(obj, QByteArray((const char *)data, obj->getNumBytes())));
+}
+
+/**
+ * Hand the queued updates over, at most one call to processUpdates() is pending
+ * at any time and it signals all the updates handed over until it runs
+ */
+void UAVTalkDispatcher::flush()
+{
+    if (incoming.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&mutex);
+    updates.append(incoming);
+    incoming.clear();
+    if (!posted) {
+        posted = true;
+        QMetaObject::invokeMethod(this, "processUpdates", Qt::QueuedConnection);
+    }
+}
+
+void UAVTalkDispatcher::processUpdates()
+{
+    QList<Update> batch;
+    {
+        QMutexLocker locker(&mutex);
+        batch.swap(updates);
+        posted = false;
+    }
+    // The object goes through the data of each update while it is signalled,
+    // and holds that of the last update of the batch afterwards
+    foreach(const Update &update, batch) {
+        update.first->unpack((const quint8 *)update.second.constData());
+    }
+}
@@ -35,9 +35,14 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QMap>
+#include <QList>
+#include <QPair>
 #include <QThread>
 #include <QtNetwork/QUdpSocket>
 
+class UAVTalkDispatcher;
+class UAVTalkDevice;
+
 class UAVTALK_EXPORT UAVTalk : public QObject {
     Q_OBJECT
 
@@ -46,6 +51,25 @@ class UAVTALK_EXPORT UAVTalk : public QObject {
 public:
     static const quint16 ALL_INSTANCES = 0xFFFF;
 
+    // Packet framing, also used by tools decoding logged streams
+    static const int SYNC_VAL      = 0x3C;
+    static const int TYPE_MASK     = 0xF8;
+    static const int TYPE_VER      = 0x20;
+    static const int TYPE_OBJ      = (TYPE_VER | 0x00);
+    static const int TYPE_OBJ_REQ  = (TYPE_VER | 0x01);
+    static const int TYPE_OBJ_ACK  = (TYPE_VER | 0x02);
+    static const int TYPE_ACK      = (TYPE_VER | 0x03);
+    static const int TYPE_NACK     = (TYPE_VER | 0x04);
+
+    // header : sync(1), type (1), size(2), object ID(4), instance ID(2)
+    static const int HEADER_LENGTH = 10;
+
+    static const int MAX_PAYLOAD_LENGTH = 256;
+
+    static const int CHECKSUM_LENGTH    = 1;
+
+    static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
+
     typedef struct {
         quint32 txBytes;
         quint32 txObjectBytes;
@@ -70,12 +94,20 @@ public:
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
     void cancelTransaction(UAVObject *obj);
 
+    // Decode the input stream in a reader thread, the device is still only read
+    // and written in its own thread and the object updates are signalled in the
+    // thread of the objects
+    void setThreadedInput(bool threaded);
+
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
+    // With threaded input, bytes are waiting for processInputStream()
+    void inputQueued();
 
 private slots:
     void processInputStream();
     void dummyUDPRead();
+    void flushMirror();
 
 private:
 
@@ -86,25 +118,10 @@ private:
     } Transaction;
 
     // Constants
-    static const int TYPE_MASK     = 0xF8;
-    static const int TYPE_VER      = 0x20;
-    static const int TYPE_OBJ      = (TYPE_VER | 0x00);
-    static const int TYPE_OBJ_REQ  = (TYPE_VER | 0x01);
-    static const int TYPE_OBJ_ACK  = (TYPE_VER | 0x02);
-    static const int TYPE_ACK      = (TYPE_VER | 0x03);
-    static const int TYPE_NACK     = (TYPE_VER | 0x04);
-
-    // header : sync(1), type (1), size(2), object ID(4), instance ID(2)
-    static const int HEADER_LENGTH = 10;
-
-    static const int MAX_PAYLOAD_LENGTH = 256;
-
-    static const int CHECKSUM_LENGTH    = 1;
-
-    static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
-
     static const int TX_BUFFER_SIZE     = 2 * 1024;
 
+    static const int RX_STREAM_BUFFER_SIZE = 16 * 1024;
+
     static const quint8 crc_table[256];
 
     // Types
@@ -121,12 +138,19 @@ private:
 
     QMutex mutex;
 
+    UAVTalkDispatcher *dispatcher;
+
+    UAVTalkDevice *device;
+
     QMap<quint32, QMap<quint32, Transaction *> *> transMap;
 
     quint8 rxBuffer[MAX_PACKET_LENGTH];
 
     quint8 txBuffer[MAX_PACKET_LENGTH];
 
+    // Bytes read from the io device in one go, framed in place
+    quint8 rxStreamBuffer[RX_STREAM_BUFFER_SIZE];
+
     // Variables used by the receive state machine
     // state machine variables
     qint32 rxCount;
@@ -146,10 +170,17 @@ private:
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
     QByteArray rxDataArray;
+    // With threaded input, packets to mirror in the thread of the sockets
+    // (true for received ones)
+    QList<QPair<bool, QByteArray> > mirrorQueue;
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
+    void processInputBuffer(const quint8 *buffer, qint64 length);
+    void mirrorPacket(const QByteArray &packet, bool received);
+    qint32 processInputPacket(const quint8 *buffer, qint64 length);
     bool processInputByte(quint8 rxbyte);
+    void processReceivedObject();
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
     UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
@@ -165,4 +196,74 @@ private:
     const char *typeToString(quint8 type);
 };
 
+/**
+ * Does the device I/O of a UAVTalk instance with threaded input, in the thread
+ * of the device, as the serial, network and USB devices are not thread safe.
+ * The bytes read are queued for the reader thread, the bytes to send are queued
+ * by the senders and written once this thread runs.
+ */
+class UAVTalkDevice : public QObject {
+    Q_OBJECT
+
+public:
+    UAVTalkDevice(QIODevice *io);
+
+    // Called by the reader thread
+    QByteArray takeInput();
+    // Called by the senders
+    void queueOutput(const char *data, qint64 length);
+    // Bytes queued or buffered by the device, not sent yet
+    qint64 outputBacklog();
+
+signals:
+    void inputQueued();
+
+public slots:
+    void read();
+
+private slots:
+    void write();
+    void outputWritten();
+
+private:
+    QPointer<QIODevice> io;
+
+    QMutex mutex;
+    QByteArray input;
+    QByteArray output;
+    qint64 deviceBacklog;
+    bool writePosted;
+};
+
+/**
+ * Signals the updates of the objects unpacked by a UAVTalk reader thread in the
+ * thread the objects live in. Every update is queued with a copy of its data and
+ * signalled in order, each object is unpacked again from its copy while it is
+ * signalled, so the receivers see the data of that update. The receivers get one
+ * queued call per batch instead of one per update.
+ */
+class UAVTalkDispatcher : public QObject {
+    Q_OBJECT
+
+public:
+    UAVTalkDispatcher();
+
+    // Called by the reader thread only
+    void postUpdate(UAVObject *obj, const quint8 *data);
+    void flush();
+
+private slots:
+    void processUpdates();
+
+private:
+    typedef QPair<UAVObject *, QByteArray> Update;
+
+    // updates that are not flushed yet, only touched by the reader thread
+    QList<Update> incoming;
+
+    QMutex mutex;
+    QList<Update> updates;
+    bool posted;
+};
+
 #endif // UAVTALK_H
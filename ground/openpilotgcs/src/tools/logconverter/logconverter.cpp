@@ -0,0 +1,451 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logconverter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Converts .opl telemetry logs into per object columnar files
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "logconverter.h"
+
+#include <uavtalk/uavtalk.h>
+#include <utils/crc.h>
+
+#include <QFile>
+#include <QTextStream>
+#include <QDataStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QVector>
+#include <QtEndian>
+#include <QDebug>
+
+using namespace Utils;
+
+// Binary column file
+#define COLUMN_FILE_MAGIC   0x4F50434C
+#define COLUMN_FILE_VERSION 1
+// Rows gathered per write when transposing a table into columns
+#define COLUMN_BLOCK_ROWS   4096
+
+/**
+ * Decodes the rows of one object type and writes its output files.
+ */
+class ObjectTableWriter : public QRunnable {
+public:
+    ObjectTableWriter(LogConverter *converter, LogConverter::ObjectTable *table) :
+        converter(converter), table(table), rows(NULL), success(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run();
+
+    bool succeeded() const
+    {
+        return success;
+    }
+
+private:
+    // One column of the table, an element of a field
+    typedef struct {
+        QString name;
+        UAVObjectField *field;
+        UAVObjectField::FieldType type;
+        quint32 index;
+        quint32 offset;
+        quint32 size;
+    } Column;
+
+    LogConverter *converter;
+    LogConverter::ObjectTable *table;
+    const quint8 *rows;
+    QVector<Column> columns;
+    bool success;
+
+    void buildColumns();
+    bool writeCsv();
+    bool writeBinary();
+    QString valueToString(const Column &column, const quint8 *data) const;
+};
+
+void ObjectTableWriter::run()
+{
+    rows = table->rows.map(0, table->rows.size());
+    if (rows == NULL) {
+        qWarning() << "Unable to map" << table->rows.fileName();
+        return;
+    }
+
+    buildColumns();
+    success = true;
+    if (converter->writeCsv) {
+        success &= writeCsv();
+    }
+    if (converter->writeBinary) {
+        success &= writeBinary();
+    }
+    table->rows.unmap((uchar *)rows);
+}
+
+void ObjectTableWriter::buildColumns()
+{
+    foreach(UAVObjectField * field, table->obj->getFields()) {
+        quint32 numElements = field->getNumElements();
+        QStringList elementNames = field->getElementNames();
+        Column column;
+
+        column.field = field;
+        column.type  = field->getType();
+        if (column.type == UAVObjectField::STRING) {
+            // A string is a single column
+            column.name   = field->getName();
+            column.index  = 0;
+            column.offset = field->getDataOffset();
+            column.size   = numElements;
+            columns.append(column);
+            continue;
+        }
+        for (quint32 index = 0; index < numElements; ++index) {
+            column.name  = (numElements > 1) ? QString("%1.%2").arg(field->getName()).arg(elementNames.value(index, QString::number(index))) : field->getName();
+            column.index = index;
+            if (column.type == UAVObjectField::BITFIELD) {
+                column.offset = field->getDataOffset() + index / 8;
+                column.size   = 1;
+            } else {
+                column.size   = field->getNumBytes() / numElements;
+                column.offset = field->getDataOffset() + index * column.size;
+            }
+            columns.append(column);
+        }
+    }
+}
+
+QString ObjectTableWriter::valueToString(const Column &column, const quint8 *data) const
+{
+    const quint8 *value = data + column.offset;
+
+    switch (column.type) {
+    case UAVObjectField::INT8:
+        return QString::number((qint8)value[0]);
+
+    case UAVObjectField::INT16:
+        return QString::number(qFromLittleEndian<qint16>(value));
+
+    case UAVObjectField::INT32:
+        return QString::number(qFromLittleEndian<qint32>(value));
+
+    case UAVObjectField::UINT8:
+        return QString::number(value[0]);
+
+    case UAVObjectField::UINT16:
+        return QString::number(qFromLittleEndian<quint16>(value));
+
+    case UAVObjectField::UINT32:
+        return QString::number(qFromLittleEndian<quint32>(value));
+
+    case UAVObjectField::FLOAT32:
+    {
+        quint32 bits = qFromLittleEndian<quint32>(value);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return QString::number(f, 'g', 9);
+    }
+
+    case UAVObjectField::ENUM:
+        return column.field->getOptions().value(value[0], QString::number(value[0]));
+
+    case UAVObjectField::BITFIELD:
+        return QString::number((value[0] >> (column.index % 8)) & 1);
+
+    case UAVObjectField::STRING:
+        return QString::fromLatin1((const char *)value, qstrnlen((const char *)value, column.size));
+    }
+    return QString();
+}
+
+bool ObjectTableWriter::writeCsv()
+{
+    QFile file(converter->outputDir.filePath(table->obj->getName() + ".csv"));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "Unable to write" << file.fileName();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "timestamp,instance";
+    foreach(const Column &column, columns) {
+        out << "," << column.name;
+    }
+    out << "\n";
+
+    const quint8 *row = rows;
+    for (int n = 0; n < table->numRows; ++n, row += table->rowSize) {
+        out << qFromLittleEndian<quint32>(row) << "," << qFromLittleEndian<quint16>(row + 4);
+        const quint8 *data = row + LogConverter::ROW_HEADER_LENGTH;
+        foreach(const Column &column, columns) {
+            out << "," << valueToString(column, data);
+        }
+        out << "\n";
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+bool ObjectTableWriter::writeBinary()
+{
+    QFile file(converter->outputDir.filePath(table->obj->getName() + ".opc"));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to write" << file.fileName();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << (quint32)COLUMN_FILE_MAGIC << (quint32)COLUMN_FILE_VERSION << table->obj->getObjID()
+        << (quint32)table->numRows << (quint32)(columns.size() + 2);
+    out << QString("timestamp") << (quint8)UAVObjectField::UINT32 << (quint32)4 << QStringList();
+    out << QString("instance") << (quint8)UAVObjectField::UINT16 << (quint32)2 << QStringList();
+    foreach(const Column &column, columns) {
+        QStringList options = (column.type == UAVObjectField::ENUM) ? column.field->getOptions() : QStringList();
+        out << column.name << (quint8)column.type << column.size << options;
+    }
+
+    // Gather each column from the spooled rows, a block of rows at a time
+    QByteArray values;
+    for (int start = 0; start < table->numRows; start += COLUMN_BLOCK_ROWS) {
+        int count = qMin(COLUMN_BLOCK_ROWS, table->numRows - start);
+        values.resize(count * 4);
+        for (int n = 0; n < count; ++n) {
+            memcpy(values.data() + n * 4, rows + (start + n) * table->rowSize, 4);
+        }
+        out.writeRawData(values.constData(), values.size());
+    }
+    for (int start = 0; start < table->numRows; start += COLUMN_BLOCK_ROWS) {
+        int count = qMin(COLUMN_BLOCK_ROWS, table->numRows - start);
+        values.resize(count * 2);
+        for (int n = 0; n < count; ++n) {
+            memcpy(values.data() + n * 2, rows + (start + n) * table->rowSize + 4, 2);
+        }
+        out.writeRawData(values.constData(), values.size());
+    }
+    foreach(const Column &column, columns) {
+        for (int start = 0; start < table->numRows; start += COLUMN_BLOCK_ROWS) {
+            int count = qMin(COLUMN_BLOCK_ROWS, table->numRows - start);
+            values.resize(count * column.size);
+            char *value = values.data();
+            for (int n = start; n < start + count; ++n, value += column.size) {
+                const quint8 *data = rows + n * table->rowSize + LogConverter::ROW_HEADER_LENGTH + column.offset;
+                if (column.type == UAVObjectField::BITFIELD) {
+                    *value = (data[0] >> (column.index % 8)) & 1;
+                } else {
+                    memcpy(value, data, column.size);
+                }
+            }
+            out.writeRawData(values.constData(), values.size());
+        }
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+LogConverter::LogConverter(UAVObjectManager *objMngr) :
+    objMngr(objMngr),
+    writeCsv(true),
+    writeBinary(true),
+    maxThreads(QThread::idealThreadCount()),
+    numObjects(0),
+    numErrors(0),
+    spoolFailed(false)
+{}
+
+LogConverter::~LogConverter()
+{
+    clear();
+}
+
+void LogConverter::clear()
+{
+    qDeleteAll(tables);
+    tables.clear();
+    stream.clear();
+    numObjects  = 0;
+    numErrors   = 0;
+    spoolFailed = false;
+}
+
+/**
+ * Convert a log file, the output files are written in the output directory.
+ * \return Success (true), Failure (false)
+ */
+bool LogConverter::convert(const QString &fileName)
+{
+    clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open" << fileName;
+        return false;
+    }
+    const char *data = (const char *)file.map(0, file.size());
+    if (data == NULL) {
+        qWarning() << "Unable to map" << fileName;
+        return false;
+    }
+
+    // The rows are spooled to the output directory while reading
+    if (!outputDir.exists() && !outputDir.mkpath(".")) {
+        qWarning() << "Unable to create" << outputDir.path();
+        file.unmap((uchar *)data);
+        return false;
+    }
+
+    // Single pass over the log records: timestamp (4), size (8), data
+    qint64 fileSize = file.size();
+    qint64 pos = 0;
+    while (pos + 12 <= fileSize) {
+        quint32 timeStamp;
+        qint64 dataSize;
+        memcpy(&timeStamp, data + pos, sizeof(timeStamp));
+        memcpy(&dataSize, data + pos + sizeof(timeStamp), sizeof(dataSize));
+        pos += sizeof(timeStamp) + sizeof(dataSize);
+        if (dataSize < 1 || dataSize > (1024 * 1024) || pos + dataSize > fileSize) {
+            qWarning() << "Logfile corrupted at offset" << pos << ", unlikely packet size" << dataSize;
+            break;
+        }
+        processRecord(timeStamp, data + pos, dataSize);
+        pos += dataSize;
+    }
+    file.unmap((uchar *)data);
+
+    bool success = !spoolFailed;
+    foreach(ObjectTable * table, tables) {
+        success &= table->rows.flush();
+    }
+    if (!success) {
+        qWarning() << "Unable to spool the rows to" << outputDir.path();
+        return false;
+    }
+
+    // Decode and write each object type in parallel
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxThreads);
+    QList<ObjectTableWriter *> writers;
+    foreach(ObjectTable * table, tables) {
+        // Tables whose rows all had the wrong size have nothing to map or write
+        if (table->numRows == 0) {
+            continue;
+        }
+        ObjectTableWriter *writer = new ObjectTableWriter(this, table);
+        writers.append(writer);
+        pool.start(writer);
+    }
+    pool.waitForDone();
+
+    foreach(ObjectTableWriter * writer, writers) {
+        success &= writer->succeeded();
+    }
+    qDeleteAll(writers);
+    return success;
+}
+
+/**
+ * Frame the UAVTalk packets of a log record, packets may span records.
+ */
+void LogConverter::processRecord(quint32 timeStamp, const char *data, qint64 length)
+{
+    stream.append(data, length);
+
+    int pos = 0;
+    while (pos < stream.size()) {
+        int sync = stream.indexOf((char)UAVTalk::SYNC_VAL, pos);
+        if (sync < 0) {
+            pos = stream.size();
+            break;
+        }
+        pos = sync;
+        if (stream.size() - pos < UAVTalk::HEADER_LENGTH) {
+            break;
+        }
+
+        const quint8 *packet = (const quint8 *)stream.constData() + pos;
+        quint8 type  = packet[1];
+        qint32 size  = qFromLittleEndian<quint16>(packet + 2);
+        if ((type & UAVTalk::TYPE_MASK) != UAVTalk::TYPE_VER || size < UAVTalk::HEADER_LENGTH ||
+            size > UAVTalk::HEADER_LENGTH + UAVTalk::MAX_PAYLOAD_LENGTH) {
+            pos++;
+            continue;
+        }
+        if (stream.size() - pos < size + UAVTalk::CHECKSUM_LENGTH) {
+            break;
+        }
+        if (Crc::updateCRC(0, packet, size) != packet[size]) {
+            numErrors++;
+            pos++;
+            continue;
+        }
+        if (type == UAVTalk::TYPE_OBJ || type == UAVTalk::TYPE_OBJ_ACK) {
+            addRow(timeStamp, qFromLittleEndian<quint32>(packet + 4), qFromLittleEndian<quint16>(packet + 8),
+                   packet + UAVTalk::HEADER_LENGTH, size - UAVTalk::HEADER_LENGTH);
+        }
+        pos += size + UAVTalk::CHECKSUM_LENGTH;
+    }
+    stream.remove(0, pos);
+}
+
+void LogConverter::addRow(quint32 timeStamp, quint32 objId, quint16 instId, const quint8 *data, qint32 length)
+{
+    ObjectTable *table = tables.value(objId);
+
+    if (table == NULL) {
+        // Only data objects are converted, metaobjects are skipped
+        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objMngr->getObject(objId));
+        if (obj == NULL) {
+            if (objMngr->getObject(objId) == NULL) {
+                numErrors++;
+            }
+            return;
+        }
+        table = new ObjectTable();
+        table->obj     = obj;
+        table->rowSize = ROW_HEADER_LENGTH + obj->getNumBytes();
+        table->numRows = 0;
+        table->rows.setFileTemplate(outputDir.filePath(obj->getName() + ".XXXXXX.rows"));
+        if (!table->rows.open()) {
+            spoolFailed = true;
+        }
+        tables.insert(objId, table);
+    }
+    if (ROW_HEADER_LENGTH + length != table->rowSize) {
+        numErrors++;
+        return;
+    }
+
+    quint8 header[ROW_HEADER_LENGTH];
+    qToLittleEndian<quint32>(timeStamp, header);
+    qToLittleEndian<quint16>(instId, header + 4);
+    if (table->rows.write((const char *)header, ROW_HEADER_LENGTH) != ROW_HEADER_LENGTH ||
+        table->rows.write((const char *)data, length) != length) {
+        spoolFailed = true;
+        return;
+    }
+    table->numRows++;
+    numObjects++;
+}
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logconverter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Converts .opl telemetry logs into per object columnar files
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOGCONVERTER_H
+#define LOGCONVERTER_H
+
+#include "uavobjectmanager.h"
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QDir>
+#include <QTemporaryFile>
+
+/**
+ * Decodes the UAVTalk stream of a .opl log in one pass and writes, for each
+ * object type found in the log, a table with one row per received update and
+ * one column per field element (plus the log timestamp and the instance ID).
+ *
+ * Tables can be written as CSV and/or in a compact binary column format
+ * (<Object>.opc):
+ *   header (little endian, QDataStream): magic "OPCL", version, object ID,
+ *   row count, column count, then for each column its name, field type
+ *   (UAVObjectField::FieldType), element size in bytes and enum options.
+ *   data: for each column, the row count values of element size bytes,
+ *   stored as received (little endian).
+ *
+ * While the log is read the rows of each object type are spooled to a
+ * temporary file in the output directory, so memory use does not grow with
+ * the length of the log. The tables are then decoded and written in
+ * parallel, one object type per task.
+ */
+class LogConverter {
+public:
+    LogConverter(UAVObjectManager *objMngr);
+    ~LogConverter();
+
+    void setOutputDirectory(const QDir &dir)
+    {
+        outputDir = dir;
+    }
+    void setOutputFormats(bool csv, bool binary)
+    {
+        writeCsv    = csv;
+        writeBinary = binary;
+    }
+    void setMaxThreads(int threads)
+    {
+        maxThreads = threads;
+    }
+
+    bool convert(const QString &fileName);
+
+    // Statistics of the last conversion
+    quint32 getNumObjects() const
+    {
+        return numObjects;
+    }
+    quint32 getNumErrors() const
+    {
+        return numErrors;
+    }
+
+private:
+    // Rows of one object type, each row is timestamp (4), instance ID (2) and the packed object data
+    struct ObjectTable {
+        UAVDataObject *obj;
+        qint32 rowSize;
+        qint32 numRows;
+        QTemporaryFile rows;
+    };
+
+    static const int ROW_HEADER_LENGTH = 6;
+
+    UAVObjectManager *objMngr;
+    QDir outputDir;
+    bool writeCsv;
+    bool writeBinary;
+    int maxThreads;
+
+    QHash<quint32, ObjectTable *> tables;
+    QByteArray stream;
+    quint32 numObjects;
+    quint32 numErrors;
+    bool spoolFailed;
+
+    void clear();
+    void processRecord(quint32 timeStamp, const char *data, qint64 length);
+    void addRow(quint32 timeStamp, quint32 objId, quint16 instId, const quint8 *data, qint32 length);
+
+    friend class ObjectTableWriter;
+};
+
+#endif // LOGCONVERTER_H
@@ -0,0 +1,37 @@
+#
+# Headless converter from .opl telemetry logs to per object columnar files
+#
+
+include(../../../openpilotgcs.pri)
+
+QT -= gui
+QT += network
+
+TEMPLATE = app
+TARGET = opllogconverter
+DESTDIR = $$GCS_APP_PATH
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../rpath.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+include(../../plugins/uavtalk/uavtalk.pri)
+
+INCLUDEPATH += $$GCS_SOURCE_TREE/src/plugins
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot
+linux-* {
+    QMAKE_LFLAGS += \'-Wl,-rpath,\$\$ORIGIN/../$$GCS_LIBRARY_BASENAME/openpilotgcs/plugins/OpenPilot\'
+}
+
+HEADERS += \
+    logconverter.h
+
+SOURCES += \
+    main.cpp \
+    logconverter.cpp
+
+!macx {
+    target.path = /bin
+    INSTALLS += target
+}
@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Command line front end of the .opl log converter
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "logconverter.h"
+#include "uavobjectsinit.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QFileInfo>
+#include <QTextStream>
+
+static void usage(QTextStream &out)
+{
+    out << "Usage: opllogconverter [options] <log.opl>..." << endl
+        << "Writes one table per UAVObject found in each log into <outdir>/<log name>/" << endl
+        << endl
+        << "Options:" << endl
+        << "  -o <outdir>  Output directory (default: the directory of each log)" << endl
+        << "  -j <n>       Number of threads (default: number of cores)" << endl
+        << "  --csv        Write CSV tables" << endl
+        << "  --binary     Write binary column tables (.opc)" << endl
+        << "               (both formats are written if none is selected)" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList args = app.arguments();
+    QStringList logs;
+    QString outDir;
+    bool csv     = false;
+    bool binary  = false;
+    int threads  = 0;
+
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args.at(i);
+        if (arg == "-o" && i + 1 < args.size()) {
+            outDir = args.at(++i);
+        } else if (arg == "-j" && i + 1 < args.size()) {
+            threads = args.at(++i).toInt();
+        } else if (arg == "--csv") {
+            csv = true;
+        } else if (arg == "--binary") {
+            binary = true;
+        } else if (arg == "-h" || arg == "--help") {
+            usage(out);
+            return 0;
+        } else if (arg.startsWith("-")) {
+            err << "Unknown option " << arg << endl;
+            usage(err);
+            return 1;
+        } else {
+            logs << arg;
+        }
+    }
+    if (logs.isEmpty()) {
+        usage(err);
+        return 1;
+    }
+    if (!csv && !binary) {
+        csv    = true;
+        binary = true;
+    }
+
+    UAVObjectManager *objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+
+    LogConverter converter(objMngr);
+    converter.setOutputFormats(csv, binary);
+    if (threads > 0) {
+        converter.setMaxThreads(threads);
+    }
+
+    int failures = 0;
+    foreach(const QString &log, logs) {
+        QFileInfo logInfo(log);
+        QDir dir(outDir.isEmpty() ? logInfo.absolutePath() : outDir);
+        converter.setOutputDirectory(QDir(dir.filePath(logInfo.completeBaseName())));
+        if (converter.convert(log)) {
+            out << log << ": " << converter.getNumObjects() << " objects, " << converter.getNumErrors() << " errors" << endl;
+        } else {
+            err << log << ": conversion failed" << endl;
+            failures++;
+        }
+    }
+
+    delete objMngr;
+    return failures ? 1 : 0;
+}
@@ -180,6 +180,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                             "   mutex->lock();\n"
                             "   bool changed = data.%2[%5] != value;\n"
                             "   data.%2[%5] = value;\n"
+                            "   notifiedData.%2[%5] = value;\n"
                             "   mutex->unlock();\n"
                             "   if (changed) emit %2_%3Changed(value);\n"
                             "}\n\n")
@@ -188,8 +189,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                     QString("    void %1_%2Changed(%3 value);\n")
                     .arg(field->name).arg(elementName).arg(type);
                 propertyNotificationsImpl +=
-                    QString("        //if (data.%1[%2] != oldData.%1[%2])\n"
-                            "            emit %1_%3Changed(data.%1[%2]);\n")
+                    QString("    if (newData.%1[%2] != oldData.%1[%2]) {\n"
+                            "        emit %1_%3Changed(newData.%1[%2]);\n"
+                            "    }\n")
                     .arg(field->name).arg(elementIndex).arg(elementName);
             }
         } else {
@@ -214,6 +216,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                         "   mutex->lock();\n"
                         "   bool changed = data.%2 != value;\n"
                         "   data.%2 = value;\n"
+                        "   notifiedData.%2 = value;\n"
                         "   mutex->unlock();\n"
                         "   if (changed) emit %2Changed(value);\n"
                         "}\n\n")
@@ -222,8 +225,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                 QString("    void %1Changed(%2 value);\n")
                 .arg(field->name).arg(type);
             propertyNotificationsImpl +=
-                QString("        //if (data.%1 != oldData.%1)\n"
-                        "            emit %1Changed(data.%1);\n")
+                QString("    if (newData.%1 != oldData.%1) {\n"
+                        "        emit %1Changed(newData.%1);\n"
+                        "    }\n")
                 .arg(field->name);
         }
     }